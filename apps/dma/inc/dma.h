@@ -0,0 +1,66 @@
+/**
+ ********************************************************************************
+ * @file    dma.h
+ * @author  prashanth kannan
+ * @date    2/28/24
+ * @brief   GPDMA memory to memory copy and fill
+ ********************************************************************************
+ */
+
+#ifndef DMA_H
+#define DMA_H
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "stdint.h"
+#include "stddef.h"
+
+// OS
+#include "FreeRTOS.h"
+
+/************************************
+ * MACROS AND DEFINES
+ ************************************/
+// Task notification index completions are counted on, index 0 is left to
+// stream buffers and other kernel objects
+#define DMA_NOTIFY_INDEX    (1U)
+// GPDMA errors are counted on their own index, one per failed request
+#define DMA_ERROR_INDEX     (2U)
+
+/************************************
+ * TYPEDEFS
+ ************************************/
+struct dma_stats {
+    uint32_t xfers;         // transfers run by the GPDMA
+    uint32_t bytes;         // bytes moved by the GPDMA
+    uint32_t cpu;           // requests done by the CPU, short or not reachable
+    uint32_t busy;          // requests done by the CPU, no slot or channel
+    uint32_t errors;        // GPDMA bus errors
+};
+
+/************************************
+ * EXPORTED VARIABLES
+ ************************************/
+
+/************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ************************************/
+void dma_init(void);
+/*
+ * Start a copy/fill and return. Each request gives the calling task one
+ * notification on DMA_NOTIFY_INDEX when it is done. The GPDMA only reaches
+ * AHB SRAM (RamAHB32), requests touching other memory are done by the CPU
+ * before returning and notified the same way.
+ */
+void dma_memcpy_async(void *dst, const void *src, size_t len);
+void dma_memset_async(void *dst, uint8_t val, size_t len);
+// Block until one request of the calling task is done, 0 on success, -1 on a
+// timeout or when a request of the task failed with a GPDMA error
+int32_t dma_wait(TickType_t timeout);
+void dma_get_stats(struct dma_stats *stats);
+#if defined(DMA_BENCH)
+void dma_bench(void);
+#endif
+
+#endif
@@ -0,0 +1,332 @@
+/**
+ ********************************************************************************
+ * @file    dma.c
+ * @author  prashanth kannan
+ * @date    2/28/24
+ * @brief   GPDMA memory to memory copy and fill
+ ********************************************************************************
+ */
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "stdint.h"
+#include "stdbool.h"
+#include "stdio.h"
+#include "string.h"
+#include "assert.h"
+
+// Drivers
+#include "LPC17xx.h"
+#include "GPDMA_LPC17xx.h"
+
+// OS
+#include "FreeRTOS.h"
+#include "task.h"
+
+// APPS
+#include "dma.h"
+
+/************************************
+ * EXTERN VARIABLES
+ ************************************/
+// AHB SRAM bounds from memory.ld, the only memory the GPDMA can reach
+extern uint8_t __base_RAM2[];
+extern uint8_t __top_RAM2[];
+
+/************************************
+ * PRIVATE MACROS AND DEFINES
+ ************************************/
+#define DMA_IRQ_PRIO        (14U)
+
+// Requests in flight, one GPDMA channel each
+#define DMA_XFER_NUM        (4U)
+
+// Shorter requests are cheaper on the CPU than setting up a channel
+#define DMA_CPU_MAX         (64U)
+
+#define DMA_CONTROL(width)  (GPDMA_CH_CONTROL_SBSIZE(GPDMA_BSIZE_4) | \
+                             GPDMA_CH_CONTROL_DBSIZE(GPDMA_BSIZE_4) | \
+                             GPDMA_CH_CONTROL_SWIDTH(width) | \
+                             GPDMA_CH_CONTROL_DWIDTH(width) | \
+                             GPDMA_CH_CONTROL_I)
+#define DMA_CONFIG          (GPDMA_CH_CONFIG_FLOWCNTRL(GPDMA_TRANSFER_M2M_CTRL_DMA) | \
+                             GPDMA_CH_CONFIG_IE | GPDMA_CH_CONFIG_ITC | \
+                             GPDMA_CH_CONFIG_E)
+
+#define DMA_BENCH_SIZE      (4096U)
+
+// One completion callback per slot, the GPDMA callback carries no context
+#define DMA_DONE_CB(n)      static void dma_done_##n(uint32_t event) { dma_done(n, event); }
+
+/************************************
+ * PRIVATE TYPEDEFS
+ ************************************/
+struct dma_xfer {
+    TaskHandle_t task;      // requesting task, NULL when the slot is free
+    uint32_t ch;
+    uint32_t len;
+};
+
+struct dma_ctx {
+    struct dma_xfer xfer[DMA_XFER_NUM];
+    struct dma_stats stats;
+};
+
+/************************************
+ * STATIC FUNCTION PROTOTYPES
+ ************************************/
+static void dma_done(uint32_t slot, uint32_t event);
+
+/************************************
+ * STATIC VARIABLES
+ ************************************/
+static struct dma_ctx ctx;
+
+// Fill patterns, the GPDMA can not read them from local SRAM
+static uint32_t dma_fill[DMA_XFER_NUM] __attribute__((section(".bss.$RAM2")));
+
+#if defined(DMA_BENCH)
+static uint8_t bench_src[DMA_BENCH_SIZE] __attribute__((section(".bss.$RAM2"), aligned(4)));
+static uint8_t bench_dst[DMA_BENCH_SIZE] __attribute__((section(".bss.$RAM2"), aligned(4)));
+#endif
+
+/************************************
+ * GLOBAL VARIABLES
+ ************************************/
+
+/************************************
+ * STATIC FUNCTIONS
+ ************************************/
+DMA_DONE_CB(0)
+DMA_DONE_CB(1)
+DMA_DONE_CB(2)
+DMA_DONE_CB(3)
+
+static const GPDMA_SignalEvent_t dma_done_cb[DMA_XFER_NUM] = {
+    dma_done_0, dma_done_1, dma_done_2, dma_done_3,
+};
+
+/*
+ * Runs from DMA_IRQHandler, the channel is no longer active
+ */
+static void dma_done(uint32_t slot, uint32_t event)
+{
+    struct dma_xfer *xfer = &ctx.xfer[slot];
+    TaskHandle_t task = xfer->task;
+    BaseType_t woken = pdFALSE;
+
+    if (event & GPDMA_EVENT_ERROR) {
+        ctx.stats.errors++;
+        vTaskNotifyGiveIndexedFromISR(task, DMA_ERROR_INDEX, &woken);
+    } else {
+        ctx.stats.xfers++;
+        ctx.stats.bytes += xfer->len;
+    }
+
+    GPDMA_ChannelRelease(xfer->ch);
+    xfer->task = NULL;
+
+    vTaskNotifyGiveIndexedFromISR(task, DMA_NOTIFY_INDEX, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+static bool dma_reachable(const void *addr, size_t len)
+{
+    uint32_t start = (uint32_t)addr;
+
+    return (start >= (uint32_t)__base_RAM2) &&
+        (len <= ((uint32_t)__top_RAM2 - start));
+}
+
+/*
+ * Claim a slot and a channel and start the transfer, false if either is
+ * taken
+ */
+static bool dma_start(uint32_t src, uint32_t dst, uint32_t num,
+    uint32_t control, uint32_t len)
+{
+    struct dma_xfer *xfer = NULL;
+    uint32_t slot;
+    int32_t ch;
+
+    taskENTER_CRITICAL();
+    for (slot = 0; slot < DMA_XFER_NUM; slot++) {
+        if (!ctx.xfer[slot].task) {
+            xfer = &ctx.xfer[slot];
+            xfer->task = xTaskGetCurrentTaskHandle();
+            break;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if (!xfer) {
+        return false;
+    }
+
+    // Bulk copies take the lowest class, peripherals keep the fast channels
+    ch = GPDMA_ChannelAllocate(GPDMA_PRIO_LOW);
+    if (ch < 0) {
+        xfer->task = NULL;
+        return false;
+    }
+    xfer->ch = ch;
+    xfer->len = len;
+
+    // Fills read the pattern from the slot's own word
+    if (!(control & GPDMA_CH_CONTROL_SI)) {
+        dma_fill[slot] = src;
+        src = (uint32_t)&dma_fill[slot];
+    }
+
+    if (GPDMA_ChannelConfigure(ch, src, dst, num, control, DMA_CONFIG,
+            dma_done_cb[slot])) {
+        GPDMA_ChannelRelease(ch);
+        xfer->task = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Requests finished by the CPU are notified like GPDMA ones
+ */
+static void dma_notify_self(void)
+{
+    xTaskNotifyGiveIndexed(xTaskGetCurrentTaskHandle(), DMA_NOTIFY_INDEX);
+}
+
+static void dma_copy(void *dst, const void *src, size_t len)
+{
+    uint32_t head = 0;
+    uint32_t tail = 0;
+    uint32_t control = DMA_CONTROL(GPDMA_WIDTH_BYTE) | GPDMA_CH_CONTROL_SI |
+        GPDMA_CH_CONTROL_DI;
+    uint32_t num = len;
+
+    if (!dma_reachable(dst, len) || !dma_reachable(src, len)) {
+        memcpy(dst, src, len);
+        ctx.stats.cpu++;
+        dma_notify_self();
+        return;
+    }
+
+    // Word transfers when both ends share the alignment, the CPU copies the
+    // unaligned head and tail while the GPDMA runs
+    if (!(((uint32_t)dst ^ (uint32_t)src) & 3U)) {
+        head = (0U - (uint32_t)dst) & 3U;
+        tail = (len - head) & 3U;
+        num = (len - head) >> 2;
+        control = DMA_CONTROL(GPDMA_WIDTH_WORD) | GPDMA_CH_CONTROL_SI |
+            GPDMA_CH_CONTROL_DI;
+    }
+
+    if (!dma_start((uint32_t)src + head, (uint32_t)dst + head, num, control,
+            len - head - tail)) {
+        memcpy(dst, src, len);
+        ctx.stats.busy++;
+        dma_notify_self();
+        return;
+    }
+
+    memcpy(dst, src, head);
+    memcpy((uint8_t *)dst + len - tail, (const uint8_t *)src + len - tail, tail);
+}
+
+/************************************
+ * GLOBAL FUNCTIONS
+ ************************************/
+void dma_init(void)
+{
+    int32_t ret = GPDMA_Initialize();
+    assert(!ret);
+
+    // Completion callbacks use the FreeRTOS ISR API
+    NVIC_SetPriority(DMA_IRQn, DMA_IRQ_PRIO);
+}
+
+void dma_memcpy_async(void *dst, const void *src, size_t len)
+{
+    if (len <= DMA_CPU_MAX) {
+        memcpy(dst, src, len);
+        ctx.stats.cpu++;
+        dma_notify_self();
+        return;
+    }
+
+    dma_copy(dst, src, len);
+}
+
+void dma_memset_async(void *dst, uint8_t val, size_t len)
+{
+    uint32_t head = (0U - (uint32_t)dst) & 3U;
+    uint32_t tail;
+
+    if ((len <= DMA_CPU_MAX) || !dma_reachable(dst, len)) {
+        memset(dst, val, len);
+        ctx.stats.cpu++;
+        dma_notify_self();
+        return;
+    }
+
+    // Word fill from an aligned start, the CPU sets the ends
+    tail = (len - head) & 3U;
+    if (!dma_start(val * 0x01010101UL, (uint32_t)dst + head,
+            (len - head) >> 2, DMA_CONTROL(GPDMA_WIDTH_WORD) |
+            GPDMA_CH_CONTROL_DI, len - head - tail)) {
+        memset(dst, val, len);
+        ctx.stats.busy++;
+        dma_notify_self();
+        return;
+    }
+
+    memset(dst, val, head);
+    memset((uint8_t *)dst + len - tail, val, tail);
+}
+
+int32_t dma_wait(TickType_t timeout)
+{
+    if (!ulTaskNotifyTakeIndexed(DMA_NOTIFY_INDEX, pdFALSE, timeout)) {
+        return -1;
+    }
+
+    // The error is counted before the completion, the buffer is only partly
+    // written
+    return ulTaskNotifyTakeIndexed(DMA_ERROR_INDEX, pdFALSE, 0) ? -1 : 0;
+}
+
+void dma_get_stats(struct dma_stats *stats)
+{
+    *stats = ctx.stats;
+}
+
+#if defined(DMA_BENCH)
+/*
+ * CPU memcpy against a GPDMA copy in AHB SRAM, in CPU cycles. The GPDMA
+ * figure runs from the request to the waiting task waking up, setup is the
+ * part the CPU is busy for.
+ */
+void dma_bench(void)
+{
+    static const uint32_t sizes[] = { 32, 256, 1536, DMA_BENCH_SIZE };
+
+    for (uint32_t i = 0; i < (sizeof(sizes) / sizeof(sizes[0])); i++) {
+        uint32_t start, cpu, setup, total;
+
+        start = DWT->CYCCNT;
+        memcpy(bench_dst, bench_src, sizes[i]);
+        cpu = DWT->CYCCNT - start;
+
+        start = DWT->CYCCNT;
+        dma_copy(bench_dst, bench_src, sizes[i]);
+        setup = DWT->CYCCNT - start;
+        dma_wait(portMAX_DELAY);
+        total = DWT->CYCCNT - start;
+
+        printf("%4lu bytes cpu %5lu dma %5lu setup %4lu cycles\r\n",
+            (unsigned long)sizes[i], (unsigned long)cpu, (unsigned long)total,
+            (unsigned long)setup);
+    }
+}
+#endif
@@ -19,6 +19,9 @@
 // APPS
 #include "hbeat.h"
 #include "serial.h"
+#include "dma.h"
+#include "net.h"
+#include "log.h"
 
 /************************************
  * EXTERN VARIABLES
@@ -48,10 +51,10 @@
  * STATIC FUNCTIONS
  ************************************/
 static void display_system_info(void) {
-    printf("******** System Info ********\n");
-    printf("MCU: LPC1768\n");
-    printf("OS: FreeRTOS %s\n", tskKERNEL_VERSION_NUMBER);
-    printf("*****************************\n");
+    LOG_INF(main, "******** System Info ********\n");
+    LOG_INF(main, "MCU: LPC1768\n");
+    LOG_INF(main, "OS: FreeRTOS %s\n", tskKERNEL_VERSION_NUMBER);
+    LOG_INF(main, "*****************************\n");
 }
 
 /************************************
@@ -61,9 +64,11 @@ int main(void)
 {
     serial_init();
     display_system_info();
+    dma_init();
 
     // Initialize apps
     hbeat_init();
+    net_init();
 
     vTaskStartScheduler();
 
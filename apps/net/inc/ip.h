@@ -0,0 +1,59 @@
+/**
+ ********************************************************************************
+ * @file    ip.h
+ * @author  prashanth kannan
+ * @date    2/28/24
+ * @brief   net internals shared by the MAC glue and the protocols
+ ********************************************************************************
+ */
+
+#ifndef IP_H
+#define IP_H
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "stdint.h"
+
+// APPS
+#include "net.h"
+
+/************************************
+ * MACROS AND DEFINES
+ ************************************/
+// Frame buffer size, a full frame without FCS rounded up to a word
+#define NET_BUF_SIZE        (1516U)
+
+#define ETH_ADDR_LEN        (6U)
+#define ETH_HDR_LEN         (14U)
+
+// Class D, 224.0.0.0/4
+#define IP4_IS_MCAST(ip)    (((ip) >> 28) == 0xEU)
+
+/************************************
+ * TYPEDEFS
+ ************************************/
+
+/************************************
+ * EXPORTED VARIABLES
+ ************************************/
+extern struct net_stats net_stats;
+
+/************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ************************************/
+// Frame buffers the MAC sends in place, NULL when all are in use
+uint8_t *net_buf_alloc(void);
+void net_buf_free(uint8_t *buf);
+// Send a frame and give up the buffer, callers hold the ip lock
+int32_t net_xmit(uint8_t *buf, uint32_t len);
+
+void ip_init(const uint8_t mac[ETH_ADDR_LEN]);
+// Net task only
+void ip_input(const uint8_t *frame, uint32_t len);
+void ip_tick(void);
+uint32_t ip_addr(void);
+// Ethernet group address an IPv4 group maps to (RFC 1112)
+void ip_mcast_mac(uint32_t group, uint8_t mac[ETH_ADDR_LEN]);
+
+#endif
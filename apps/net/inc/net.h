@@ -0,0 +1,89 @@
+/**
+ ********************************************************************************
+ * @file    net.h
+ * @author  prashanth kannan
+ * @date    2/28/24
+ * @brief   ARP/IPv4/ICMP/UDP on the Ethernet MAC
+ ********************************************************************************
+ */
+
+#ifndef NET_H
+#define NET_H
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "stdint.h"
+#include "stdbool.h"
+
+/************************************
+ * MACROS AND DEFINES
+ ************************************/
+// Host order IPv4 address from its dotted parts
+#define NET_IP4(a, b, c, d) (((uint32_t)(a) << 24) | ((uint32_t)(b) << 16) | \
+                             ((uint32_t)(c) << 8) | (uint32_t)(d))
+#define NET_IP4_BCAST       (0xFFFFFFFFUL)
+
+// Largest UDP payload that fits an Ethernet frame without IP fragmentation
+#define NET_UDP_MAX         (1472U)
+
+/************************************
+ * TYPEDEFS
+ ************************************/
+/*
+ * UDP receive handler, runs in the net task. The data is only valid during
+ * the call, net_udp_send may be called from it.
+ */
+typedef void (*net_udp_handler)(uint32_t src_ip, uint16_t src_port,
+    const uint8_t *data, uint32_t len);
+
+// Link change handler, runs in the net task
+typedef void (*net_link_handler)(bool up);
+
+struct net_stats {
+    uint32_t rx_frames;     // frames taken from the MAC
+    uint32_t rx_errors;     // frames the MAC dropped, bad CRC or checksum
+    uint32_t rx_dropped;    // frames not for us or not handled
+    uint32_t tx_frames;     // frames handed to the MAC
+    uint32_t tx_dropped;    // sends failed, no link, buffer or descriptor
+    uint32_t arp_misses;    // sends that had to resolve the address first
+    uint32_t icmp_echo;     // echo requests answered
+    uint32_t udp_rx;        // datagrams passed to a handler
+    uint32_t rx_irqs;       // receive interrupts
+    uint32_t rx_budget;     // polls that used the whole budget
+    uint32_t rx_fps;        // frames taken last second
+    uint32_t rx_irq_ps;     // receive interrupts last second
+    uint32_t mcast_pass;    // group frames passed by the MAC hash filter
+    uint32_t mcast_drop;    // of those, groups not joined sharing a hash bin
+};
+
+/************************************
+ * EXPORTED VARIABLES
+ ************************************/
+
+/************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ************************************/
+void net_init(void);
+bool net_link_up(void);
+void net_on_link(net_link_handler handler);
+void net_get_stats(struct net_stats *stats);
+void net_get_addr(uint32_t *ip, uint8_t mac[6]);
+// Handle datagrams to a local port, 0 on success
+int32_t net_udp_bind(uint16_t port, net_udp_handler handler);
+/*
+ * Receive datagrams sent to an IPv4 group, joins are counted and each needs
+ * a leave. No IGMP reports are sent. 0 on success.
+ */
+int32_t net_mcast_join(uint32_t group);
+int32_t net_mcast_leave(uint32_t group);
+/*
+ * Send a datagram from any task, the data is copied before returning.
+ * A destination not in the ARP cache is resolved first, one datagram per
+ * destination waits for it. 0 when queued to the MAC or waiting for the
+ * address.
+ */
+int32_t net_udp_send(uint32_t dst_ip, uint16_t dst_port, uint16_t src_port,
+    const void *data, uint32_t len);
+
+#endif
@@ -0,0 +1,646 @@
+/**
+ ********************************************************************************
+ * @file    ip.c
+ * @author  prashanth kannan
+ * @date    2/28/24
+ * @brief   ARP, IPv4, ICMP echo and UDP
+ ********************************************************************************
+ */
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "stdint.h"
+#include "stdbool.h"
+#include "string.h"
+#include "assert.h"
+
+// Drivers
+#include "IP_CSUM.h"
+
+// OS
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+// APPS
+#include "net.h"
+#include "ip.h"
+
+/************************************
+ * EXTERN VARIABLES
+ ************************************/
+
+/************************************
+ * PRIVATE MACROS AND DEFINES
+ ************************************/
+// Static address, comma separated parts from the build
+#ifndef NET_IP_ADDR
+#define NET_IP_ADDR         192, 168, 1, 50
+#endif
+#ifndef NET_NETMASK
+#define NET_NETMASK         255, 255, 255, 0
+#endif
+#ifndef NET_GATEWAY
+#define NET_GATEWAY         192, 168, 1, 1
+#endif
+#define IP_CFG(...)         NET_IP4(__VA_ARGS__)
+
+#define ARP_NUM             (4U)
+#define ARP_RETRY_TICKS     (pdMS_TO_TICKS(1000))
+#define ARP_TRIES           (3U)
+#define ARP_EXPIRE_TICKS    (pdMS_TO_TICKS(300000))
+
+#define UDP_BIND_NUM        (4U)
+
+#define ETH_TYPE_IP4        (0x0800U)
+#define ETH_TYPE_ARP        (0x0806U)
+
+// Field offsets from the start of the frame
+#define ETH_DST             (0U)
+#define ETH_SRC             (6U)
+#define ETH_TYPE            (12U)
+
+#define ARP_HTYPE           (ETH_HDR_LEN + 0U)
+#define ARP_PTYPE           (ETH_HDR_LEN + 2U)
+#define ARP_HLEN            (ETH_HDR_LEN + 4U)
+#define ARP_PLEN            (ETH_HDR_LEN + 5U)
+#define ARP_OPER            (ETH_HDR_LEN + 6U)
+#define ARP_SHA             (ETH_HDR_LEN + 8U)
+#define ARP_SPA             (ETH_HDR_LEN + 14U)
+#define ARP_THA             (ETH_HDR_LEN + 18U)
+#define ARP_TPA             (ETH_HDR_LEN + 24U)
+#define ARP_FRAME_LEN       (ETH_HDR_LEN + 28U)
+#define ARP_REQUEST         (1U)
+#define ARP_REPLY           (2U)
+
+#define IP_VHL              (ETH_HDR_LEN + 0U)
+#define IP_LEN              (ETH_HDR_LEN + 2U)
+#define IP_ID               (ETH_HDR_LEN + 4U)
+#define IP_FRAG             (ETH_HDR_LEN + 6U)
+#define IP_TTL              (ETH_HDR_LEN + 8U)
+#define IP_PROTO            (ETH_HDR_LEN + 9U)
+#define IP_CSUM             (ETH_HDR_LEN + 10U)
+#define IP_SRC              (ETH_HDR_LEN + 12U)
+#define IP_DST              (ETH_HDR_LEN + 16U)
+#define IP_HDR_LEN          (20U)
+#define IP_FRAME_MIN        (ETH_HDR_LEN + IP_HDR_LEN)
+#define IP_FRAG_MASK        (0x3FFFU)   // more fragments and offset
+#define IP_TTL_DEFAULT      (64U)
+#define IP_PROTO_ICMP       (1U)
+#define IP_PROTO_UDP        (17U)
+
+// Offsets from the start of the IP payload
+#define ICMP_TYPE           (0U)
+#define ICMP_CSUM           (2U)
+#define ICMP_HDR_LEN        (8U)
+#define ICMP_ECHO_REPLY     (0U)
+#define ICMP_ECHO_REQUEST   (8U)
+
+#define UDP_SPORT           (0U)
+#define UDP_DPORT           (2U)
+#define UDP_LEN             (4U)
+#define UDP_CSUM            (6U)
+#define UDP_HDR_LEN         (8U)
+
+/************************************
+ * PRIVATE TYPEDEFS
+ ************************************/
+enum arp_state {
+    ARP_FREE,
+    ARP_PENDING,
+    ARP_VALID,
+};
+
+struct arp_entry {
+    uint32_t ip;
+    uint8_t mac[ETH_ADDR_LEN];
+    uint8_t state;
+    uint8_t tries;
+    TickType_t time;        // last request sent or reply seen
+    uint8_t *pending;       // frame waiting for the address
+    uint32_t pending_len;
+};
+
+struct udp_bind {
+    uint16_t port;          // 0 when the slot is free
+    net_udp_handler handler;
+};
+
+struct ip_ctx {
+    SemaphoreHandle_t lock; // ARP cache, IP ident and MAC transmit
+    uint8_t mac[ETH_ADDR_LEN];
+    uint32_t addr;
+    uint32_t mask;
+    uint32_t gw;
+    uint16_t ident;
+    struct arp_entry arp[ARP_NUM];
+    struct udp_bind udp[UDP_BIND_NUM];
+};
+
+/************************************
+ * STATIC FUNCTION PROTOTYPES
+ ************************************/
+
+/************************************
+ * STATIC VARIABLES
+ ************************************/
+static struct ip_ctx ctx;
+
+static const uint8_t eth_bcast[ETH_ADDR_LEN] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+
+/************************************
+ * GLOBAL VARIABLES
+ ************************************/
+
+/************************************
+ * STATIC FUNCTIONS
+ ************************************/
+static uint16_t get16(const uint8_t *p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+        ((uint32_t)p[2] << 8) | p[3];
+}
+
+static void put16(uint8_t *p, uint16_t val)
+{
+    p[0] = (uint8_t)(val >> 8);
+    p[1] = (uint8_t)val;
+}
+
+static void put32(uint8_t *p, uint32_t val)
+{
+    p[0] = (uint8_t)(val >> 24);
+    p[1] = (uint8_t)(val >> 16);
+    p[2] = (uint8_t)(val >> 8);
+    p[3] = (uint8_t)val;
+}
+
+/*
+ * Checksums are summed in memory order, the folded complement is stored as is
+ */
+static void put_csum(uint8_t *p, uint32_t sum)
+{
+    uint16_t csum = (uint16_t)~IP_CSUM_Fold(sum);
+
+    memcpy(p, &csum, sizeof(csum));
+}
+
+static void eth_header(uint8_t *frame, const uint8_t *dst, uint16_t type)
+{
+    memcpy(&frame[ETH_DST], dst, ETH_ADDR_LEN);
+    memcpy(&frame[ETH_SRC], ctx.mac, ETH_ADDR_LEN);
+    put16(&frame[ETH_TYPE], type);
+}
+
+/*
+ * ARP request or reply, callers hold the lock
+ */
+static void arp_send(uint16_t oper, const uint8_t *tha, uint32_t tpa)
+{
+    uint8_t *frame = net_buf_alloc();
+
+    if (!frame) {
+        net_stats.tx_dropped++;
+        return;
+    }
+
+    eth_header(frame, (oper == ARP_REQUEST) ? eth_bcast : tha, ETH_TYPE_ARP);
+    put16(&frame[ARP_HTYPE], 1U);
+    put16(&frame[ARP_PTYPE], ETH_TYPE_IP4);
+    frame[ARP_HLEN] = ETH_ADDR_LEN;
+    frame[ARP_PLEN] = 4U;
+    put16(&frame[ARP_OPER], oper);
+    memcpy(&frame[ARP_SHA], ctx.mac, ETH_ADDR_LEN);
+    put32(&frame[ARP_SPA], ctx.addr);
+    if (oper == ARP_REQUEST) {
+        memset(&frame[ARP_THA], 0, ETH_ADDR_LEN);
+    } else {
+        memcpy(&frame[ARP_THA], tha, ETH_ADDR_LEN);
+    }
+    put32(&frame[ARP_TPA], tpa);
+
+    net_xmit(frame, ARP_FRAME_LEN);
+}
+
+static struct arp_entry *arp_find(uint32_t ip)
+{
+    for (uint32_t i = 0; i < ARP_NUM; i++) {
+        if ((ctx.arp[i].state != ARP_FREE) && (ctx.arp[i].ip == ip)) {
+            return &ctx.arp[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void arp_clear(struct arp_entry *entry)
+{
+    if (entry->pending) {
+        net_buf_free(entry->pending);
+        net_stats.tx_dropped++;
+    }
+    entry->pending = NULL;
+    entry->state = ARP_FREE;
+}
+
+/*
+ * A free entry, or the oldest one when the cache is full
+ */
+static struct arp_entry *arp_alloc(uint32_t ip)
+{
+    TickType_t now = xTaskGetTickCount();
+    struct arp_entry *entry = &ctx.arp[0];
+
+    for (uint32_t i = 0; i < ARP_NUM; i++) {
+        if (ctx.arp[i].state == ARP_FREE) {
+            entry = &ctx.arp[i];
+            break;
+        }
+        if ((now - ctx.arp[i].time) > (now - entry->time)) {
+            entry = &ctx.arp[i];
+        }
+    }
+
+    arp_clear(entry);
+    entry->ip = ip;
+    return entry;
+}
+
+/*
+ * Learn a sender address, a frame waiting for it goes out
+ */
+static void arp_update(struct arp_entry *entry, const uint8_t *mac)
+{
+    memcpy(entry->mac, mac, ETH_ADDR_LEN);
+    entry->state = ARP_VALID;
+    entry->time = xTaskGetTickCount();
+
+    if (entry->pending) {
+        memcpy(&entry->pending[ETH_DST], mac, ETH_ADDR_LEN);
+        net_xmit(entry->pending, entry->pending_len);
+        entry->pending = NULL;
+    }
+}
+
+static void arp_input(const uint8_t *frame, uint32_t len)
+{
+    struct arp_entry *entry;
+    uint32_t spa, tpa;
+
+    if ((len < ARP_FRAME_LEN) || (get16(&frame[ARP_HTYPE]) != 1U) ||
+        (get16(&frame[ARP_PTYPE]) != ETH_TYPE_IP4) ||
+        (frame[ARP_HLEN] != ETH_ADDR_LEN) || (frame[ARP_PLEN] != 4U)) {
+        net_stats.rx_dropped++;
+        return;
+    }
+
+    spa = get32(&frame[ARP_SPA]);
+    tpa = get32(&frame[ARP_TPA]);
+
+    xSemaphoreTake(ctx.lock, portMAX_DELAY);
+
+    // Refresh a known sender, add it when the request is for us (RFC 826)
+    entry = arp_find(spa);
+    if (!entry && (tpa == ctx.addr)) {
+        entry = arp_alloc(spa);
+    }
+    if (entry) {
+        arp_update(entry, &frame[ARP_SHA]);
+    }
+
+    if ((tpa == ctx.addr) && (get16(&frame[ARP_OPER]) == ARP_REQUEST)) {
+        arp_send(ARP_REPLY, &frame[ARP_SHA], spa);
+    }
+
+    xSemaphoreGive(ctx.lock);
+}
+
+static void ip_header(uint8_t *frame, uint32_t dst, uint8_t proto, uint32_t len)
+{
+    frame[IP_VHL] = 0x45U;
+    frame[IP_VHL + 1U] = 0U;
+    put16(&frame[IP_LEN], (uint16_t)(IP_HDR_LEN + len));
+    put16(&frame[IP_ID], ctx.ident++);
+    put16(&frame[IP_FRAG], 0U);
+    frame[IP_TTL] = IP_TTL_DEFAULT;
+    frame[IP_PROTO] = proto;
+    put16(&frame[IP_CSUM], 0U);
+    put32(&frame[IP_SRC], ctx.addr);
+    put32(&frame[IP_DST], dst);
+    put_csum(&frame[IP_CSUM], IP_CSUM_Add(0, &frame[ETH_HDR_LEN], IP_HDR_LEN));
+}
+
+/*
+ * Fill the headers in and send the frame, resolving the next hop first if
+ * needed. Callers hold the lock, the frame buffer is given up.
+ */
+static void ip_output(uint8_t *frame, uint32_t dst, uint8_t proto, uint32_t len)
+{
+    struct arp_entry *entry;
+    uint32_t hop = dst;
+
+    ip_header(frame, dst, proto, len);
+    len += IP_FRAME_MIN;
+
+    if ((dst == NET_IP4_BCAST) || (dst == (ctx.addr | ~ctx.mask))) {
+        eth_header(frame, eth_bcast, ETH_TYPE_IP4);
+        net_xmit(frame, len);
+        return;
+    }
+
+    if (IP4_IS_MCAST(dst)) {
+        uint8_t mac[ETH_ADDR_LEN];
+
+        ip_mcast_mac(dst, mac);
+        eth_header(frame, mac, ETH_TYPE_IP4);
+        net_xmit(frame, len);
+        return;
+    }
+
+    if ((dst & ctx.mask) != (ctx.addr & ctx.mask)) {
+        hop = ctx.gw;
+    }
+
+    eth_header(frame, eth_bcast, ETH_TYPE_IP4);
+    entry = arp_find(hop);
+    if (entry && (entry->state == ARP_VALID)) {
+        memcpy(&frame[ETH_DST], entry->mac, ETH_ADDR_LEN);
+        net_xmit(frame, len);
+        return;
+    }
+
+    // One frame waits per destination, a newer one replaces it
+    net_stats.arp_misses++;
+    if (!entry) {
+        entry = arp_alloc(hop);
+        entry->state = ARP_PENDING;
+        entry->tries = 1U;
+        entry->time = xTaskGetTickCount();
+        arp_send(ARP_REQUEST, NULL, hop);
+    }
+    arp_clear(entry);
+    entry->state = ARP_PENDING;
+    entry->pending = frame;
+    entry->pending_len = len;
+}
+
+static void icmp_input(const uint8_t *frame, uint32_t src, const uint8_t *data,
+    uint32_t len)
+{
+    uint8_t *reply;
+    uint8_t *icmp;
+
+    if ((len < ICMP_HDR_LEN) || (data[ICMP_TYPE] != ICMP_ECHO_REQUEST)) {
+        net_stats.rx_dropped++;
+        return;
+    }
+
+    reply = net_buf_alloc();
+    if (!reply) {
+        net_stats.tx_dropped++;
+        return;
+    }
+
+    // Same payload back, the sender's address is known from the request
+    icmp = &reply[IP_FRAME_MIN];
+    memcpy(icmp, data, len);
+    icmp[ICMP_TYPE] = ICMP_ECHO_REPLY;
+    put16(&icmp[ICMP_CSUM], 0U);
+    put_csum(&icmp[ICMP_CSUM], IP_CSUM_Add(0, icmp, len));
+
+    xSemaphoreTake(ctx.lock, portMAX_DELAY);
+    ip_header(reply, src, IP_PROTO_ICMP, len);
+    eth_header(reply, &frame[ETH_SRC], ETH_TYPE_IP4);
+    net_xmit(reply, IP_FRAME_MIN + len);
+    xSemaphoreGive(ctx.lock);
+
+    net_stats.icmp_echo++;
+}
+
+static void udp_input(uint32_t src, const uint8_t *data, uint32_t len)
+{
+    uint32_t ulen = (len >= UDP_HDR_LEN) ? get16(&data[UDP_LEN]) : 0;
+    uint16_t port;
+
+    if ((ulen < UDP_HDR_LEN) || (ulen > len)) {
+        net_stats.rx_dropped++;
+        return;
+    }
+
+    port = get16(&data[UDP_DPORT]);
+
+    for (uint32_t i = 0; i < UDP_BIND_NUM; i++) {
+        net_udp_handler handler = ctx.udp[i].handler;
+
+        if (ctx.udp[i].port == port) {
+            net_stats.udp_rx++;
+            handler(src, get16(&data[UDP_SPORT]), &data[UDP_HDR_LEN],
+                ulen - UDP_HDR_LEN);
+            return;
+        }
+    }
+
+    net_stats.rx_dropped++;
+}
+
+static void ip4_input(const uint8_t *frame, uint32_t len)
+{
+    uint32_t hlen, tlen, dst;
+
+    if (len < IP_FRAME_MIN) {
+        net_stats.rx_dropped++;
+        return;
+    }
+
+    hlen = (frame[IP_VHL] & 0x0FU) * 4U;
+    tlen = get16(&frame[IP_LEN]);
+    dst = get32(&frame[IP_DST]);
+
+    // Fragments are not reassembled, groups were filtered by the MAC
+    if (((frame[IP_VHL] >> 4) != 4U) || (hlen < IP_HDR_LEN) ||
+        (tlen < hlen) || (tlen > (len - ETH_HDR_LEN)) ||
+        (get16(&frame[IP_FRAG]) & IP_FRAG_MASK) ||
+        ((dst != ctx.addr) && (dst != NET_IP4_BCAST) &&
+         (dst != (ctx.addr | ~ctx.mask)) && !IP4_IS_MCAST(dst))) {
+        net_stats.rx_dropped++;
+        return;
+    }
+
+    // Checksums were checked by the MAC driver
+    switch (frame[IP_PROTO]) {
+    case IP_PROTO_ICMP:
+        if (dst == ctx.addr) {
+            icmp_input(frame, get32(&frame[IP_SRC]),
+                &frame[ETH_HDR_LEN + hlen], tlen - hlen);
+        } else {
+            net_stats.rx_dropped++;
+        }
+        break;
+    case IP_PROTO_UDP:
+        udp_input(get32(&frame[IP_SRC]), &frame[ETH_HDR_LEN + hlen],
+            tlen - hlen);
+        break;
+    default:
+        net_stats.rx_dropped++;
+        break;
+    }
+}
+
+/************************************
+ * GLOBAL FUNCTIONS
+ ************************************/
+void ip_init(const uint8_t mac[ETH_ADDR_LEN])
+{
+    memcpy(ctx.mac, mac, ETH_ADDR_LEN);
+    ctx.addr = IP_CFG(NET_IP_ADDR);
+    ctx.mask = IP_CFG(NET_NETMASK);
+    ctx.gw = IP_CFG(NET_GATEWAY);
+
+    ctx.lock = xSemaphoreCreateMutex();
+    assert(ctx.lock);
+}
+
+uint32_t ip_addr(void)
+{
+    return ctx.addr;
+}
+
+void ip_mcast_mac(uint32_t group, uint8_t mac[ETH_ADDR_LEN])
+{
+    mac[0] = 0x01U;
+    mac[1] = 0x00U;
+    mac[2] = 0x5EU;
+    mac[3] = (uint8_t)((group >> 16) & 0x7FU);
+    mac[4] = (uint8_t)(group >> 8);
+    mac[5] = (uint8_t)group;
+}
+
+void ip_input(const uint8_t *frame, uint32_t len)
+{
+    if (len < ETH_HDR_LEN) {
+        net_stats.rx_dropped++;
+        return;
+    }
+
+    switch (get16(&frame[ETH_TYPE])) {
+    case ETH_TYPE_ARP:
+        arp_input(frame, len);
+        break;
+    case ETH_TYPE_IP4:
+        ip4_input(frame, len);
+        break;
+    default:
+        net_stats.rx_dropped++;
+        break;
+    }
+}
+
+/*
+ * Retry unanswered requests and age the cache out
+ */
+void ip_tick(void)
+{
+    TickType_t now = xTaskGetTickCount();
+
+    xSemaphoreTake(ctx.lock, portMAX_DELAY);
+    for (uint32_t i = 0; i < ARP_NUM; i++) {
+        struct arp_entry *entry = &ctx.arp[i];
+
+        if ((entry->state == ARP_PENDING) &&
+            ((now - entry->time) >= ARP_RETRY_TICKS)) {
+            if (entry->tries >= ARP_TRIES) {
+                arp_clear(entry);
+                continue;
+            }
+            entry->tries++;
+            entry->time = now;
+            arp_send(ARP_REQUEST, NULL, entry->ip);
+        } else if ((entry->state == ARP_VALID) &&
+            ((now - entry->time) >= ARP_EXPIRE_TICKS)) {
+            arp_clear(entry);
+        }
+    }
+    xSemaphoreGive(ctx.lock);
+}
+
+int32_t net_udp_bind(uint16_t port, net_udp_handler handler)
+{
+    int32_t ret = -1;
+
+    if (!port || !handler) {
+        return -1;
+    }
+
+    xSemaphoreTake(ctx.lock, portMAX_DELAY);
+    for (uint32_t i = 0; i < UDP_BIND_NUM; i++) {
+        if (ctx.udp[i].port == port) {
+            break;
+        }
+        if (!ctx.udp[i].port) {
+            // Handler first, the net task matches on the port
+            ctx.udp[i].handler = handler;
+            ctx.udp[i].port = port;
+            ret = 0;
+            break;
+        }
+    }
+    xSemaphoreGive(ctx.lock);
+
+    return ret;
+}
+
+int32_t net_udp_send(uint32_t dst_ip, uint16_t dst_port, uint16_t src_port,
+    const void *data, uint32_t len)
+{
+    uint8_t pseudo[12];
+    uint8_t *frame;
+    uint8_t *udp;
+    uint32_t sum;
+    uint16_t csum;
+
+    if ((len > NET_UDP_MAX) || !net_link_up()) {
+        net_stats.tx_dropped++;
+        return -1;
+    }
+
+    frame = net_buf_alloc();
+    if (!frame) {
+        net_stats.tx_dropped++;
+        return -1;
+    }
+
+    // Summed in the copy, MAC transmit offload would take a second pass
+    udp = &frame[IP_FRAME_MIN];
+    put16(&udp[UDP_SPORT], src_port);
+    put16(&udp[UDP_DPORT], dst_port);
+    put16(&udp[UDP_LEN], (uint16_t)(UDP_HDR_LEN + len));
+    put16(&udp[UDP_CSUM], 0U);
+
+    put32(&pseudo[0], ctx.addr);
+    put32(&pseudo[4], dst_ip);
+    put16(&pseudo[8], IP_PROTO_UDP);
+    put16(&pseudo[10], (uint16_t)(UDP_HDR_LEN + len));
+
+    sum = IP_CSUM_Copy(IP_CSUM_Add(0, pseudo, sizeof(pseudo)),
+        &udp[UDP_HDR_LEN], data, len);
+    csum = (uint16_t)~IP_CSUM_Fold(IP_CSUM_Add(sum, udp, UDP_HDR_LEN));
+    // Zero means no checksum, its complement is sent instead
+    if (!csum) {
+        csum = 0xFFFFU;
+    }
+    memcpy(&udp[UDP_CSUM], &csum, sizeof(csum));
+
+    xSemaphoreTake(ctx.lock, portMAX_DELAY);
+    ip_output(frame, dst_ip, IP_PROTO_UDP, UDP_HDR_LEN + len);
+    xSemaphoreGive(ctx.lock);
+
+    return 0;
+}
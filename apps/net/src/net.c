@@ -0,0 +1,524 @@
+/**
+ ********************************************************************************
+ * @file    net.c
+ * @author  prashanth kannan
+ * @date    2/28/24
+ * @brief   Ethernet MAC and PHY glue, net task and frame buffers
+ ********************************************************************************
+ */
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "stdint.h"
+#include "stdbool.h"
+#include "stdio.h"
+#include "string.h"
+#include "assert.h"
+
+// Drivers
+#include "LPC17xx.h"
+#include "EMAC_LPC17xx.h"
+
+// OS
+#include "FreeRTOS.h"
+#include "task.h"
+
+// APPS
+#include "net.h"
+#include "ip.h"
+#include "log.h"
+
+/************************************
+ * EXTERN VARIABLES
+ ************************************/
+extern ARM_DRIVER_ETH_MAC Driver_ETH_MAC0;
+
+/************************************
+ * PRIVATE MACROS AND DEFINES
+ ************************************/
+// Above the GPDMA and UART, the MAC has only a few Rx descriptors
+#define ENET_IRQ_PRIO       (13U)
+
+#define NET_TASK_NAME       "net"
+#define NET_TASK_PRIO       (2U)
+#define NET_STACK_SIZE      (192U)
+
+// Link and ARP housekeeping period
+#define NET_POLL_TICKS      (pdMS_TO_TICKS(100))
+#define NET_RATE_TICKS      (pdMS_TO_TICKS(1000))
+
+/*
+ * Frames taken per poll with the Rx interrupt masked, the task then sleeps a
+ * tick and the MAC drops what does not fit the ring. 0 takes an interrupt
+ * for every burst and reads all frames.
+ */
+#ifndef NET_RX_BUDGET
+#define NET_RX_BUDGET       (16U)
+#endif
+
+// Frame buffers for sending, in AHB SRAM where the MAC can reach them
+#define NET_BUF_NUM         (4U)
+
+// PHY on the MII management bus, IEEE 802.3 clause 22 registers
+#ifndef NET_PHY_ADDR
+#define NET_PHY_ADDR        (1U)
+#endif
+
+#define PHY_REG_BMCR        (0U)
+#define PHY_REG_BMSR        (1U)
+#define PHY_REG_ANAR        (4U)
+#define PHY_REG_ANLPAR      (5U)
+
+#define PHY_BMCR_RESET      (0x8000U)
+#define PHY_BMCR_AN_EN      (0x1000U)
+#define PHY_BMCR_AN_RESTART (0x0200U)
+#define PHY_BMSR_LINK       (0x0004U)
+#define PHY_BMSR_AN_DONE    (0x0020U)
+#define PHY_AN_100FD        (0x0100U)
+#define PHY_AN_100HD        (0x0080U)
+#define PHY_AN_10FD         (0x0040U)
+
+// An MII frame takes about 25 us, anything longer is a stuck bus
+#define PHY_MII_TICKS       (pdMS_TO_TICKS(10))
+
+// Locally administered default address
+#ifndef NET_MAC_ADDR
+#define NET_MAC_ADDR        0x02, 0x00, 0x00, 0x17, 0x68, 0x01
+#endif
+
+/************************************
+ * PRIVATE TYPEDEFS
+ ************************************/
+// PHY management steps, each but idle waits for one MII access
+enum phy_state {
+    PHY_IDLE,           // next link check NET_POLL_TICKS after the last step
+    PHY_RESET,          // reset written
+    PHY_RESET_WAIT,     // control read until the reset bit clears
+    PHY_AN_START,       // autonegotiation enable written
+    PHY_STATUS,         // link status read
+    PHY_ANAR,           // own abilities read
+    PHY_ANLPAR,         // link partner abilities read
+};
+
+struct net_phy {
+    enum phy_state state;
+    TickType_t time;    // last step started
+    uint16_t anar;
+};
+
+struct net_ctx {
+    TaskHandle_t task;
+    net_link_handler link_handler;
+    struct net_phy phy;
+    volatile uint32_t buf_free;     // one bit per free frame buffer
+    bool link;
+    bool rx_poll;                   // Rx interrupt masked, ring not drained
+    uint32_t rate_frames;           // counters at the last rate update
+    uint32_t rate_irqs;
+};
+
+/************************************
+ * STATIC FUNCTION PROTOTYPES
+ ************************************/
+
+/************************************
+ * STATIC VARIABLES
+ ************************************/
+static struct net_ctx ctx = {
+    .buf_free = (1UL << NET_BUF_NUM) - 1U,
+};
+
+static const uint8_t net_mac[ETH_ADDR_LEN] = { NET_MAC_ADDR };
+
+static uint8_t net_buf[NET_BUF_NUM][NET_BUF_SIZE]
+    __attribute__((section(".noinit.$RAM2"), aligned(4)));
+
+/************************************
+ * GLOBAL VARIABLES
+ ************************************/
+struct net_stats net_stats;
+
+/************************************
+ * STATIC FUNCTIONS
+ ************************************/
+/*
+ * Runs from ENET_IRQHandler
+ */
+static void net_mac_event(uint32_t event)
+{
+    BaseType_t woken = pdFALSE;
+
+    if (event & ARM_ETH_MAC_EVENT_RX_FRAME) {
+        net_stats.rx_irqs++;
+        vTaskNotifyGiveFromISR(ctx.task, &woken);
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+/*
+ * Runs from ENET_IRQHandler once the MAC has sent a loaned buffer
+ */
+static void net_tx_release(const uint8_t *frame)
+{
+    UBaseType_t state = taskENTER_CRITICAL_FROM_ISR();
+    ctx.buf_free |= 1UL << ((frame - &net_buf[0][0]) / NET_BUF_SIZE);
+    taskEXIT_CRITICAL_FROM_ISR(state);
+}
+
+static void link_down(void)
+{
+    ctx.link = false;
+    Driver_ETH_MAC0.Control(ARM_ETH_MAC_CONTROL_RX, 0);
+    Driver_ETH_MAC0.Control(ARM_ETH_MAC_CONTROL_TX, 0);
+    LOG_INF(net, "link down\n");
+
+    if (ctx.link_handler) {
+        ctx.link_handler(false);
+    }
+}
+
+/*
+ * Set the MAC up for the best mode both ends advertise
+ */
+static void link_up(uint16_t an)
+{
+    uint32_t mode = ARM_ETH_MAC_SPEED_10M | ARM_ETH_MAC_DUPLEX_HALF;
+
+    if (an & PHY_AN_100FD) {
+        mode = ARM_ETH_MAC_SPEED_100M | ARM_ETH_MAC_DUPLEX_FULL;
+    } else if (an & PHY_AN_100HD) {
+        mode = ARM_ETH_MAC_SPEED_100M | ARM_ETH_MAC_DUPLEX_HALF;
+    } else if (an & PHY_AN_10FD) {
+        mode = ARM_ETH_MAC_SPEED_10M | ARM_ETH_MAC_DUPLEX_FULL;
+    }
+
+    Driver_ETH_MAC0.Control(ARM_ETH_MAC_CONFIGURE, mode |
+        ARM_ETH_MAC_ADDRESS_BROADCAST | ARM_ETH_MAC_CHECKSUM_OFFLOAD_RX);
+    Driver_ETH_MAC0.Control(ARM_ETH_MAC_CONTROL_TX, 1);
+    Driver_ETH_MAC0.Control(ARM_ETH_MAC_CONTROL_RX, 1);
+    ctx.link = true;
+    LOG_INF(net, "link up %s %s duplex\n",
+        (mode & ARM_ETH_MAC_SPEED_100M) ? "100M" : "10M",
+        (mode & ARM_ETH_MAC_DUPLEX_FULL) ? "full" : "half");
+
+    if (ctx.link_handler) {
+        ctx.link_handler(true);
+    }
+}
+
+/*
+ * Start the MII access of a step, a failed start waits for the next check
+ */
+static void phy_next(enum phy_state state)
+{
+    int32_t ret = ARM_DRIVER_OK;
+
+    ctx.phy.state = state;
+    ctx.phy.time = xTaskGetTickCount();
+
+    switch (state) {
+    case PHY_RESET:
+        ret = EMAC_PHY_WriteStart(NET_PHY_ADDR, PHY_REG_BMCR, PHY_BMCR_RESET);
+        break;
+    case PHY_RESET_WAIT:
+        ret = EMAC_PHY_ReadStart(NET_PHY_ADDR, PHY_REG_BMCR);
+        break;
+    case PHY_AN_START:
+        ret = EMAC_PHY_WriteStart(NET_PHY_ADDR, PHY_REG_BMCR,
+            PHY_BMCR_AN_EN | PHY_BMCR_AN_RESTART);
+        break;
+    case PHY_STATUS:
+        ret = EMAC_PHY_ReadStart(NET_PHY_ADDR, PHY_REG_BMSR);
+        break;
+    case PHY_ANAR:
+        ret = EMAC_PHY_ReadStart(NET_PHY_ADDR, PHY_REG_ANAR);
+        break;
+    case PHY_ANLPAR:
+        ret = EMAC_PHY_ReadStart(NET_PHY_ADDR, PHY_REG_ANLPAR);
+        break;
+    default:
+        break;
+    }
+
+    if (ret) {
+        ctx.phy.state = PHY_IDLE;
+    }
+}
+
+/*
+ * Advance PHY management by at most one MII access, the net task runs this
+ * every tick while a step is in progress and never waits for the MII
+ */
+static void phy_step(void)
+{
+    TickType_t elapsed = xTaskGetTickCount() - ctx.phy.time;
+    uint16_t val;
+    bool link;
+    int32_t ret;
+
+    if (ctx.phy.state == PHY_IDLE) {
+        if (elapsed >= NET_POLL_TICKS) {
+            phy_next(PHY_STATUS);
+        }
+        return;
+    }
+
+    ret = EMAC_PHY_Poll(&val);
+    if (ret == ARM_DRIVER_ERROR_BUSY) {
+        if (elapsed >= PHY_MII_TICKS) {
+            ctx.phy.state = PHY_IDLE;
+        }
+        return;
+    }
+    if (ret) {
+        ctx.phy.state = PHY_IDLE;
+        return;
+    }
+
+    switch (ctx.phy.state) {
+    case PHY_RESET:
+        phy_next(PHY_RESET_WAIT);
+        break;
+    case PHY_RESET_WAIT:
+        phy_next((val & PHY_BMCR_RESET) ? PHY_RESET_WAIT : PHY_AN_START);
+        break;
+    case PHY_STATUS:
+        link = (val & PHY_BMSR_LINK) && (val & PHY_BMSR_AN_DONE);
+        if (link && !ctx.link) {
+            phy_next(PHY_ANAR);
+            break;
+        }
+        if (!link && ctx.link) {
+            link_down();
+        }
+        ctx.phy.state = PHY_IDLE;
+        break;
+    case PHY_ANAR:
+        ctx.phy.anar = val;
+        phy_next(PHY_ANLPAR);
+        break;
+    case PHY_ANLPAR:
+        link_up(ctx.phy.anar & val);
+        ctx.phy.state = PHY_IDLE;
+        break;
+    default:
+        ctx.phy.state = PHY_IDLE;
+        break;
+    }
+}
+
+/*
+ * Hand up to budget received frames to IP in place, the buffer goes back to
+ * the driver right after. Returns the frames taken.
+ */
+static uint32_t net_rx(uint32_t budget)
+{
+    uint32_t count = 0;
+    uint8_t *frame;
+    int32_t len;
+
+    while ((count < budget) && ((len = EMAC_RxFrameLoan(&frame)) != 0)) {
+        count++;
+        if (len == ARM_DRIVER_ERROR) {
+            net_stats.rx_errors++;
+            continue;
+        }
+        if (len < 0) {
+            // No spare buffer, the next notification retries
+            break;
+        }
+        net_stats.rx_frames++;
+        ip_input(frame, len);
+        EMAC_RxFrameReturn(frame);
+    }
+
+    return count;
+}
+
+#if (NET_RX_BUDGET > 0)
+/*
+ * Interrupts stay masked while the budget runs out, under a flood the task
+ * gives the CPU up every tick instead of taking an interrupt per frame
+ */
+static void net_rx_poll(void)
+{
+    if (net_rx(NET_RX_BUDGET) == NET_RX_BUDGET) {
+        net_stats.rx_budget++;
+        ctx.rx_poll = true;
+        vTaskDelay(1);
+        return;
+    }
+
+    ctx.rx_poll = (EMAC_RxIrqEnable() > 0);
+}
+#endif
+
+static void net_rate(void)
+{
+    net_stats.rx_fps = net_stats.rx_frames - ctx.rate_frames;
+    net_stats.rx_irq_ps = net_stats.rx_irqs - ctx.rate_irqs;
+    ctx.rate_frames = net_stats.rx_frames;
+    ctx.rate_irqs = net_stats.rx_irqs;
+}
+
+static void net_task(void *arg)
+{
+    TickType_t last = xTaskGetTickCount();
+    TickType_t rate = last;
+
+    (void)arg;
+
+    phy_next(PHY_RESET);
+
+    while (1) {
+        // A tick at a time while the PHY is being talked to
+        TickType_t wait = (ctx.phy.state == PHY_IDLE) ? NET_POLL_TICKS : 1;
+
+#if (NET_RX_BUDGET > 0)
+        if (!ctx.rx_poll) {
+            ulTaskNotifyTake(pdTRUE, wait);
+        }
+        net_rx_poll();
+#else
+        ulTaskNotifyTake(pdTRUE, wait);
+        net_rx(UINT32_MAX);
+#endif
+        phy_step();
+
+        if ((xTaskGetTickCount() - last) >= NET_POLL_TICKS) {
+            last = xTaskGetTickCount();
+            ip_tick();
+        }
+        if ((xTaskGetTickCount() - rate) >= NET_RATE_TICKS) {
+            rate += NET_RATE_TICKS;
+            net_rate();
+        }
+    }
+}
+
+/************************************
+ * GLOBAL FUNCTIONS
+ ************************************/
+void net_init(void)
+{
+    int32_t ret;
+    BaseType_t ok;
+
+    ret = Driver_ETH_MAC0.Initialize(net_mac_event);
+    assert(!ret);
+    ret = EMAC_SetTxRelease(net_tx_release);
+    assert(!ret);
+    ret = EMAC_SetRxPoll(NET_RX_BUDGET > 0);
+    assert(!ret);
+
+    // MAC events use the FreeRTOS ISR API
+    NVIC_SetPriority(ENET_IRQn, ENET_IRQ_PRIO);
+    ret = Driver_ETH_MAC0.PowerControl(ARM_POWER_FULL);
+    assert(!ret);
+    ret = Driver_ETH_MAC0.SetMacAddress((const ARM_ETH_MAC_ADDR *)net_mac);
+    assert(!ret);
+
+    ip_init(net_mac);
+
+    ok = xTaskCreate(net_task, NET_TASK_NAME, NET_STACK_SIZE, NULL,
+        NET_TASK_PRIO, &ctx.task);
+    assert(ok);
+}
+
+bool net_link_up(void)
+{
+    return ctx.link;
+}
+
+void net_on_link(net_link_handler handler)
+{
+    ctx.link_handler = handler;
+}
+
+void net_get_stats(struct net_stats *stats)
+{
+    EMAC_STATS mac;
+
+    *stats = net_stats;
+    EMAC_GetStats(&mac);
+    stats->mcast_pass = mac.hash_pass;
+    stats->mcast_drop = mac.hash_drop;
+}
+
+int32_t net_mcast_join(uint32_t group)
+{
+    ARM_ETH_MAC_ADDR mac;
+    int32_t ret;
+
+    if (!IP4_IS_MCAST(group)) {
+        return -1;
+    }
+    ip_mcast_mac(group, mac.b);
+
+    // The net task checks received frames against the group table
+    taskENTER_CRITICAL();
+    ret = EMAC_JoinGroup(&mac);
+    taskEXIT_CRITICAL();
+
+    return ret ? -1 : 0;
+}
+
+int32_t net_mcast_leave(uint32_t group)
+{
+    ARM_ETH_MAC_ADDR mac;
+    int32_t ret;
+
+    if (!IP4_IS_MCAST(group)) {
+        return -1;
+    }
+    ip_mcast_mac(group, mac.b);
+
+    taskENTER_CRITICAL();
+    ret = EMAC_LeaveGroup(&mac);
+    taskEXIT_CRITICAL();
+
+    return ret ? -1 : 0;
+}
+
+void net_get_addr(uint32_t *ip, uint8_t mac[6])
+{
+    *ip = ip_addr();
+    memcpy(mac, net_mac, ETH_ADDR_LEN);
+}
+
+uint8_t *net_buf_alloc(void)
+{
+    uint8_t *buf = NULL;
+
+    taskENTER_CRITICAL();
+    if (ctx.buf_free) {
+        uint32_t n = 31U - __CLZ(ctx.buf_free);
+        ctx.buf_free &= ~(1UL << n);
+        buf = net_buf[n];
+    }
+    taskEXIT_CRITICAL();
+
+    return buf;
+}
+
+void net_buf_free(uint8_t *buf)
+{
+    taskENTER_CRITICAL();
+    ctx.buf_free |= 1UL << ((buf - &net_buf[0][0]) / NET_BUF_SIZE);
+    taskEXIT_CRITICAL();
+}
+
+int32_t net_xmit(uint8_t *buf, uint32_t len)
+{
+    int32_t ret = ctx.link ? EMAC_TxFrameLoan(buf, len, 0) : ARM_DRIVER_ERROR;
+
+    if (ret) {
+        net_buf_free(buf);
+        net_stats.tx_dropped++;
+        return -1;
+    }
+
+    net_stats.tx_frames++;
+    return 0;
+}
@@ -0,0 +1,36 @@
+/**
+ ********************************************************************************
+ * @file    console.h
+ * @author  prashanth kannan
+ * @date    2/28/24
+ * @brief   serial console line editing and command dispatch
+ ********************************************************************************
+ */
+
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "stdint.h"
+#include "stddef.h"
+
+/************************************
+ * MACROS AND DEFINES
+ ************************************/
+
+/************************************
+ * TYPEDEFS
+ ************************************/
+
+/************************************
+ * EXPORTED VARIABLES
+ ************************************/
+
+/************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ************************************/
+void console_input(const char *buf, size_t len);
+
+#endif
@@ -0,0 +1,52 @@
+/**
+ ********************************************************************************
+ * @file    format.h
+ * @author  prashanth kannan
+ * @date    2/28/24
+ * @brief   allocation free printf formatting engine
+ ********************************************************************************
+ */
+
+#ifndef FORMAT_H
+#define FORMAT_H
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "stdint.h"
+#include "stddef.h"
+#include "stdarg.h"
+
+/************************************
+ * MACROS AND DEFINES
+ ************************************/
+// %f/%F support, pulls in the soft float double routines when enabled
+#ifndef FMT_FLOAT_EN
+#define FMT_FLOAT_EN        (1)
+#endif
+
+/************************************
+ * TYPEDEFS
+ ************************************/
+// Output sink, called with each formatted chunk in order
+typedef void (*fmt_out_t)(void *arg, const char *buf, size_t len);
+
+// Argument source, a va_list when va is set, otherwise an array of 32-bit
+// words where 64-bit and double conversions take two words, low word first
+struct fmt_args {
+    va_list *va;
+    const uint32_t *argv;
+    uint32_t argc;
+};
+
+/************************************
+ * EXPORTED VARIABLES
+ ************************************/
+
+/************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ************************************/
+int fmt_format(fmt_out_t out, void *arg, const char *format, struct fmt_args *args);
+int fmt_snformat(char *buf, size_t size, const char *format, struct fmt_args *args);
+
+#endif
@@ -0,0 +1,91 @@
+/**
+ ********************************************************************************
+ * @file    log.h
+ * @author  prashanth kannan
+ * @date    2/28/24
+ * @brief   leveled, per module filtered logging on top of serial
+ ********************************************************************************
+ */
+
+#ifndef LOG_H
+#define LOG_H
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "stdint.h"
+#include "stdbool.h"
+
+// APPS
+#include "serial.h"
+
+/************************************
+ * MACROS AND DEFINES
+ ************************************/
+#define LOG_LEVEL_NONE      (0U)
+#define LOG_LEVEL_ERROR     (1U)
+#define LOG_LEVEL_WARN      (2U)
+#define LOG_LEVEL_INFO      (3U)
+#define LOG_LEVEL_DEBUG     (4U)
+#define LOG_LEVEL_NUM       (5U)
+
+// Build time threshold, levels above it are compiled out together with their
+// arguments. Set from SERIAL_LOG_LEVEL in toolchain_gcc_cfg.cmake.
+#ifndef LOG_LEVEL
+#define LOG_LEVEL           LOG_LEVEL_INFO
+#endif
+
+/*
+ * Runtime filter, checked before the arguments are evaluated. The module is a
+ * bare name from enum log_module, e.g. LOG_INF(main, "up\n").
+ */
+#define LOG_ON(level, mod) \
+    (((level) <= LOG_LEVEL) && (log_mask[(level)] & (1UL << LOG_MOD_##mod)))
+
+#define LOG_AT(level, tag, mod, format, ...) \
+    do { \
+        if (LOG_ON(level, mod)) { \
+            printf(tag " " #mod ": " format, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+#define LOG_ERR(mod, format, ...)   LOG_AT(LOG_LEVEL_ERROR, "E", mod, format, ##__VA_ARGS__)
+#define LOG_WRN(mod, format, ...)   LOG_AT(LOG_LEVEL_WARN, "W", mod, format, ##__VA_ARGS__)
+#define LOG_INF(mod, format, ...)   LOG_AT(LOG_LEVEL_INFO, "I", mod, format, ##__VA_ARGS__)
+#define LOG_DBG(mod, format, ...)   LOG_AT(LOG_LEVEL_DEBUG, "D", mod, format, ##__VA_ARGS__)
+
+// Interrupt context variant, deferred through isr_printf
+#define ISR_LOG(level, mod, format, ...) \
+    do { \
+        if (LOG_ON(level, mod)) { \
+            isr_printf(#mod ": " format, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+/************************************
+ * TYPEDEFS
+ ************************************/
+// Log modules, one bit each in the runtime mask
+enum log_module {
+    LOG_MOD_main,
+    LOG_MOD_hbeat,
+    LOG_MOD_serial,
+    LOG_MOD_net,
+    LOG_MOD_NUM,
+};
+
+/************************************
+ * EXPORTED VARIABLES
+ ************************************/
+// Modules enabled at each level, bit n is enum log_module n
+extern volatile uint32_t log_mask[LOG_LEVEL_NUM];
+
+/************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ************************************/
+void log_set_level(uint32_t mod, uint32_t level);
+uint32_t log_get_level(uint32_t mod);
+const char *log_module_name(uint32_t mod);
+int32_t log_module_find(const char *name);
+
+#endif
@@ -13,14 +13,103 @@
 /************************************
  * INCLUDES
  ************************************/
+#include "stdint.h"
+#include "stdbool.h"
 
 /************************************
  * MACROS AND DEFINES
  ************************************/
+// Maximum number of arguments carried by a deferred ISR log record
+#define ISR_LOG_MAX_ARGS    (4U)
+
+// Argument helpers for the log macros, up to 8 arguments. Counts go on to 16
+// so that callers can reject longer lists with a static assert, those expand
+// to nothing through SERIAL_MAP_X.
+#define SERIAL_MAX_ARGS     8
+#define SERIAL_NARGS(...)   SERIAL_NARGS_(0, ##__VA_ARGS__, 16, 15, 14, 13, 12, 11, 10, 9, \
+                                8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define SERIAL_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, \
+                      _15, _16, n, ...) n
+#define SERIAL_MAPN(...)    SERIAL_NARGS_(0, ##__VA_ARGS__, X, X, X, X, X, X, X, X, \
+                                8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define SERIAL_CAT(a, b)    SERIAL_CAT_(a, b)
+#define SERIAL_CAT_(a, b)   a##b
+#define SERIAL_MAP(m, ...)  SERIAL_CAT(SERIAL_MAP_, SERIAL_MAPN(__VA_ARGS__))(m, ##__VA_ARGS__)
+#define SERIAL_MAP_X(m, ...)
+#define SERIAL_MAP_0(m)
+#define SERIAL_MAP_1(m, a)                      m(0, a)
+#define SERIAL_MAP_2(m, a, b)                   m(0, a) m(1, b)
+#define SERIAL_MAP_3(m, a, b, c)                m(0, a) m(1, b) m(2, c)
+#define SERIAL_MAP_4(m, a, b, c, d)             m(0, a) m(1, b) m(2, c) m(3, d)
+#define SERIAL_MAP_5(m, a, b, c, d, e)          SERIAL_MAP_4(m, a, b, c, d) m(4, e)
+#define SERIAL_MAP_6(m, a, b, c, d, e, f)       SERIAL_MAP_5(m, a, b, c, d, e) m(5, f)
+#define SERIAL_MAP_7(m, a, b, c, d, e, f, g)    SERIAL_MAP_6(m, a, b, c, d, e, f) m(6, g)
+#define SERIAL_MAP_8(m, a, b, c, d, e, f, g, h) SERIAL_MAP_7(m, a, b, c, d, e, f, g) m(7, h)
+
+/*
+ * Raw 32-bit argument array and the bit mask of string arguments. Each
+ * argument takes one word, so 64-bit and floating point arguments, which
+ * fmt_format expects as two words, are rejected at compile time.
+ */
+#define SERIAL_ARG(i, x) \
+    ((void)sizeof(struct { _Static_assert((sizeof((x) + 0) <= sizeof(uint32_t)) && \
+        !_Generic((x), float: 1, double: 1, long double: 1, default: 0), \
+        "log arguments must fit 32 bits"); int i_; }), (uint32_t)(x)),
+#define SERIAL_ARGV(...)    ((const uint32_t[]){ SERIAL_MAP(SERIAL_ARG, ##__VA_ARGS__) 0 })
+#define SERIAL_STR(i, x)    | ((uint32_t)_Generic((x), char *: 1, const char *: 1, default: 0) << (i))
+#define SERIAL_STR_MASK(...) (0U SERIAL_MAP(SERIAL_STR, ##__VA_ARGS__))
+
+#if defined(SERIAL_LOG_TOKENIZED)
+/*
+ * Tokenized log mode. Format strings are placed in the .log_fmt section, which
+ * only exists in the ELF, and their offset in it is sent as the record ID
+ * followed by the varint encoded arguments. Each record is COBS framed and
+ * ends in a zero byte, so the decoder can pick up mid stream and resync after
+ * a lost byte. tools/log_decode.py turns the stream back into text. Format
+ * strings must be literals.
+ */
+#define SERIAL_TOK_ID(format) \
+    ({ static const char fmt_[] __attribute__((section(".log_fmt"), used)) = format; \
+       (uint32_t)fmt_; })
+
+#define printf(format, ...) \
+    ({ _Static_assert(SERIAL_NARGS(__VA_ARGS__) <= SERIAL_MAX_ARGS, "too many printf arguments"); \
+       serial_tok_log(SERIAL_TOK_ID(format), SERIAL_STR_MASK(__VA_ARGS__), \
+           SERIAL_ARGV(__VA_ARGS__), SERIAL_NARGS(__VA_ARGS__)); })
+
+#define isr_printf(format, ...) \
+    ({ _Static_assert(SERIAL_NARGS(__VA_ARGS__) <= ISR_LOG_MAX_ARGS, "too many isr_printf arguments"); \
+       serial_isr_tok_log(SERIAL_TOK_ID(format), SERIAL_STR_MASK(__VA_ARGS__), \
+           SERIAL_ARGV(__VA_ARGS__), SERIAL_NARGS(__VA_ARGS__)); })
+#else
+/*
+ * printf for interrupt context. Only the format pointer and the raw 32-bit
+ * arguments are queued, the serial task formats them later. %s arguments
+ * must point to strings that outlive the call, e.g. literals. No kernel call
+ * is made, so any interrupt priority may log, the serial task picks the
+ * records up within a tick.
+ */
+#define isr_printf(format, ...) \
+    ({ _Static_assert(SERIAL_NARGS(__VA_ARGS__) <= ISR_LOG_MAX_ARGS, "too many isr_printf arguments"); \
+       serial_isr_log((format), SERIAL_ARGV(__VA_ARGS__), SERIAL_NARGS(__VA_ARGS__)); })
+#endif
 
 /************************************
  * TYPEDEFS
  ************************************/
+struct serial_stats {
+    uint32_t dropped;       // Bytes dropped because the log ring was full
+    uint32_t hwm;           // Log ring occupancy high-water mark in bytes
+    uint32_t isr_dropped;   // ISR log records dropped because the queue was full
+    uint32_t tx_bytes;      // Bytes sent to the UART
+    uint32_t tx_spans;      // Send calls, one completion interrupt each
+    uint32_t tx_cycles;     // CPU cycles spent starting spans in Send
+    uint32_t irq_cycles;    // CPU cycles in the UART0 and its DMA interrupts
+    bool tx_dma;            // Spans sent by GPDMA rather than THRE interrupts
+    uint32_t rx_dropped;    // Console bytes dropped because the stream was full
+    uint32_t task_bufs;     // Per-task log buffers handed out
+    uint32_t task_dropped;  // Bytes dropped because a task's own buffer was full
+};
 
 /************************************
  * EXPORTED VARIABLES
@@ -30,7 +119,16 @@
  * GLOBAL FUNCTION PROTOTYPES
  ************************************/
 void serial_init(void);
-void serial_tx(const char *buf, uint32_t len);
+uint32_t serial_tx(const void *buf, uint32_t len);
+void serial_get_stats(struct serial_stats *stats);
+int32_t serial_set_baud(uint32_t baud);
+uint32_t serial_get_baud(uint32_t *actual, int32_t *error_ppm);
+void serial_task_deleted(void *task);
+void serial_isr_log(const char *format, const uint32_t *argv, uint32_t argc);
+#if defined(SERIAL_LOG_TOKENIZED)
+int serial_tok_log(uint32_t id, uint32_t str_mask, const uint32_t *argv, uint32_t argc);
+void serial_isr_tok_log(uint32_t id, uint32_t str_mask, const uint32_t *argv, uint32_t argc);
+#endif
 int cprintf(const char *format, ...);
 
 #endif 
\ No newline at end of file
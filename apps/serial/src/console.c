@@ -0,0 +1,375 @@
+/**
+ ********************************************************************************
+ * @file    console.c
+ * @author  prashanth kannan
+ * @date    2/28/24
+ * @brief   serial console line editing and command dispatch
+ ********************************************************************************
+ */
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "stdint.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+
+// Drivers
+#include "Driver_Common.h"
+#include "GPDMA_LPC17xx.h"
+#include "EMAC_LPC17xx.h"
+
+// OS
+#include "FreeRTOS.h"
+#include "task.h"
+
+// APPS
+#include "serial.h"
+#include "console.h"
+#include "log.h"
+#include "dma.h"
+#include "net.h"
+
+/************************************
+ * EXTERN VARIABLES
+ ************************************/
+
+/************************************
+ * PRIVATE MACROS AND DEFINES
+ ************************************/
+#define CONSOLE_LINE_SIZE   (48U)
+#define CONSOLE_MAX_ARGS    (4U)
+#define CONSOLE_PROMPT      "> "
+
+#define CHAR_CTRL_C         ('\x03')
+#define CHAR_BS             ('\b')
+#define CHAR_CTRL_U         ('\x15')
+#define CHAR_DEL            ('\x7F')
+
+#define ARRAY_SIZE(a)       (sizeof(a) / sizeof((a)[0]))
+
+/************************************
+ * PRIVATE TYPEDEFS
+ ************************************/
+struct console_cmd {
+    const char *name;
+    const char *help;
+    void (*handler)(int argc, char *argv[]);
+};
+
+struct console_ctx {
+    char line[CONSOLE_LINE_SIZE];
+    uint32_t len;
+    char prev;
+};
+
+/************************************
+ * STATIC FUNCTION PROTOTYPES
+ ************************************/
+static void cmd_help(int argc, char *argv[]);
+static void cmd_stats(int argc, char *argv[]);
+static void cmd_heap(int argc, char *argv[]);
+static void cmd_uptime(int argc, char *argv[]);
+static void cmd_baud(int argc, char *argv[]);
+static void cmd_log(int argc, char *argv[]);
+static void cmd_dma(int argc, char *argv[]);
+static void cmd_net(int argc, char *argv[]);
+
+/************************************
+ * STATIC VARIABLES
+ ************************************/
+static const struct console_cmd cmds[] = {
+    { "help",   "list commands",            cmd_help   },
+    { "stats",  "serial log counters",      cmd_stats  },
+    { "heap",   "free and minimum heap",    cmd_heap   },
+    { "uptime", "ticks since boot",         cmd_uptime },
+    { "baud",   "[rate] show or set baud",  cmd_baud   },
+    { "log",    "[module level] log levels", cmd_log    },
+    { "dma",    "[bench] copy and irq stats", cmd_dma  },
+    { "net",    "[mac] address and counters", cmd_net  },
+};
+
+static const char * const level_names[LOG_LEVEL_NUM] = {
+    "none", "error", "warn", "info", "debug",
+};
+
+static struct console_ctx ctx;
+
+/************************************
+ * GLOBAL VARIABLES
+ ************************************/
+
+/************************************
+ * STATIC FUNCTIONS
+ ************************************/
+static void cmd_help(int argc, char *argv[])
+{
+    for (uint32_t i = 0; i < ARRAY_SIZE(cmds); i++) {
+        printf("%s - %s\r\n", cmds[i].name, cmds[i].help);
+    }
+}
+
+static void cmd_stats(int argc, char *argv[])
+{
+    struct serial_stats stats;
+
+    serial_get_stats(&stats);
+    printf("log dropped %lu hwm %lu isr dropped %lu\r\n",
+        (unsigned long)stats.dropped, (unsigned long)stats.hwm,
+        (unsigned long)stats.isr_dropped);
+    // Interrupt cycles include console input and Send calls made from the
+    // completion callback. Compare builds with and without
+    // RTE_UART0_DMA_TX_EN at each baud rate.
+    printf("tx %s bytes %lu spans %lu cycles %lu irq cycles %lu\r\n",
+        stats.tx_dma ? "dma" : "irq", (unsigned long)stats.tx_bytes,
+        (unsigned long)stats.tx_spans, (unsigned long)stats.tx_cycles,
+        (unsigned long)stats.irq_cycles);
+    printf("rx dropped %lu task bufs %lu dropped %lu\r\n",
+        (unsigned long)stats.rx_dropped, (unsigned long)stats.task_bufs,
+        (unsigned long)stats.task_dropped);
+}
+
+static void cmd_heap(int argc, char *argv[])
+{
+    printf("heap free %lu min %lu\r\n",
+        (unsigned long)xPortGetFreeHeapSize(),
+        (unsigned long)xPortGetMinimumEverFreeHeapSize());
+}
+
+static void cmd_uptime(int argc, char *argv[])
+{
+    printf("uptime %lu ticks %lu tasks\r\n",
+        (unsigned long)xTaskGetTickCount(),
+        (unsigned long)uxTaskGetNumberOfTasks());
+}
+
+static void cmd_baud(int argc, char *argv[])
+{
+    uint32_t actual;
+    int32_t error_ppm;
+    uint32_t req;
+
+    if (argc > 1) {
+        uint32_t baud = strtoul(argv[1], NULL, 10);
+
+        if (!baud || (serial_set_baud(baud) != ARM_DRIVER_OK)) {
+            printf("baud %s not supported\r\n", argv[1]);
+            return;
+        }
+    }
+
+    req = serial_get_baud(&actual, &error_ppm);
+    printf("baud %lu actual %lu error %ld ppm\r\n", (unsigned long)req,
+        (unsigned long)actual, (long)error_ppm);
+}
+
+static void cmd_log(int argc, char *argv[])
+{
+    if (argc > 2) {
+        int32_t mod = log_module_find(argv[1]);
+        uint32_t level;
+
+        for (level = 0; level < LOG_LEVEL_NUM; level++) {
+            if (!strcmp(argv[2], level_names[level])) {
+                break;
+            }
+        }
+
+        if ((mod < 0) || (level >= LOG_LEVEL_NUM)) {
+            printf("log <module> <none|error|warn|info|debug>\r\n");
+            return;
+        }
+        log_set_level(mod, level);
+    }
+
+    for (uint32_t i = 0; i < LOG_MOD_NUM; i++) {
+        printf("%-8s %s\r\n", log_module_name(i), level_names[log_get_level(i)]);
+    }
+    printf("build level %s\r\n", level_names[LOG_LEVEL]);
+}
+
+static void cmd_dma(int argc, char *argv[])
+{
+    struct dma_stats stats;
+
+    if ((argc > 1) && !strcmp(argv[1], "bench")) {
+#if defined(DMA_BENCH)
+        dma_bench();
+#else
+        printf("dma bench not built, set DMA_BENCH\r\n");
+#endif
+        return;
+    }
+
+    dma_get_stats(&stats);
+    printf("dma xfers %lu bytes %lu errors %lu\r\n",
+        (unsigned long)stats.xfers, (unsigned long)stats.bytes,
+        (unsigned long)stats.errors);
+    printf("cpu %lu busy %lu\r\n", (unsigned long)stats.cpu,
+        (unsigned long)stats.busy);
+
+    // Interrupt entry to callback, channels that signaled anything
+    for (uint8_t ch = 0; ch < GPDMA_NUMBER_OF_CHANNELS; ch++) {
+        uint32_t max;
+        uint32_t last = GPDMA_ChannelGetLatency(ch, &max);
+
+        if (max) {
+            printf("ch %u irq latency %lu max %lu cycles\r\n", ch,
+                (unsigned long)last, (unsigned long)max);
+        }
+    }
+}
+
+/*
+ * EMAC driver counters, read while the driver updates them
+ */
+static void cmd_net_mac(void)
+{
+    EMAC_STATS stats;
+
+    EMAC_GetStats(&stats);
+    printf("rx frames %lu bytes %lu crc %lu overrun %lu dropped %lu\r\n",
+        (unsigned long)stats.rx_frames, (unsigned long)stats.rx_bytes,
+        (unsigned long)stats.rx_crc_err, (unsigned long)stats.rx_overrun,
+        (unsigned long)stats.rx_dropped);
+    printf("rx ring full %lu high water %lu\r\n",
+        (unsigned long)stats.rx_ring_full, (unsigned long)stats.rx_ring_hwm);
+    printf("tx frames %lu bytes %lu errors %lu busy %lu high water %lu\r\n",
+        (unsigned long)stats.tx_frames, (unsigned long)stats.tx_bytes,
+        (unsigned long)stats.tx_errors, (unsigned long)stats.tx_busy,
+        (unsigned long)stats.tx_ring_hwm);
+}
+
+static void cmd_net(int argc, char *argv[])
+{
+    struct net_stats stats;
+    uint8_t mac[6];
+    uint32_t ip;
+
+    if ((argc > 1) && !strcmp(argv[1], "mac")) {
+        cmd_net_mac();
+        return;
+    }
+
+    net_get_addr(&ip, mac);
+    net_get_stats(&stats);
+    printf("ip %lu.%lu.%lu.%lu\r\n",
+        (unsigned long)(ip >> 24), (unsigned long)((ip >> 16) & 0xFFU),
+        (unsigned long)((ip >> 8) & 0xFFU), (unsigned long)(ip & 0xFFU));
+    printf("mac %02x:%02x:%02x:%02x:%02x:%02x link %s\r\n",
+        mac[0], mac[1], mac[2], mac[3], mac[4], mac[5],
+        net_link_up() ? "up" : "down");
+    printf("rx frames %lu errors %lu dropped %lu\r\n",
+        (unsigned long)stats.rx_frames, (unsigned long)stats.rx_errors,
+        (unsigned long)stats.rx_dropped);
+    printf("tx frames %lu dropped %lu arp misses %lu\r\n",
+        (unsigned long)stats.tx_frames, (unsigned long)stats.tx_dropped,
+        (unsigned long)stats.arp_misses);
+    printf("icmp echo %lu udp rx %lu\r\n", (unsigned long)stats.icmp_echo,
+        (unsigned long)stats.udp_rx);
+    printf("rx %lu frames/s %lu irqs/s, irqs %lu budget hits %lu\r\n",
+        (unsigned long)stats.rx_fps, (unsigned long)stats.rx_irq_ps,
+        (unsigned long)stats.rx_irqs, (unsigned long)stats.rx_budget);
+    printf("mcast hash passed %lu dropped %lu\r\n",
+        (unsigned long)stats.mcast_pass, (unsigned long)stats.mcast_drop);
+}
+
+/*
+ * Split the line in place on spaces and run the matching command
+ */
+static void console_exec(char *line)
+{
+    char *argv[CONSOLE_MAX_ARGS];
+    int argc = 0;
+
+    while (*line) {
+        while (*line == ' ') {
+            *line++ = '\0';
+        }
+        if (!*line) {
+            break;
+        }
+        if (argc == CONSOLE_MAX_ARGS) {
+            printf("too many arguments\r\n");
+            return;
+        }
+        argv[argc++] = line;
+        while (*line && (*line != ' ')) {
+            line++;
+        }
+    }
+
+    if (!argc) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < ARRAY_SIZE(cmds); i++) {
+        if (!strcmp(argv[0], cmds[i].name)) {
+            cmds[i].handler(argc, argv);
+            return;
+        }
+    }
+
+    printf("%s: unknown command\r\n", argv[0]);
+}
+
+/*
+ * Echo is left out in tokenized mode, the host decoder only expects records
+ */
+static void console_echo(const char *buf, uint32_t len)
+{
+#if !defined(SERIAL_LOG_TOKENIZED)
+    serial_tx(buf, len);
+#endif
+}
+
+/************************************
+ * GLOBAL FUNCTIONS
+ ************************************/
+void console_input(const char *buf, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        char c = buf[i];
+        char prev = ctx.prev;
+
+        ctx.prev = c;
+        switch (c) {
+            case '\r':
+            case '\n':
+                // Second half of a CR LF pair
+                if (((prev == '\r') || (prev == '\n')) && (prev != c)) {
+                    ctx.prev = '\0';
+                    break;
+                }
+                console_echo("\r\n", 2);
+                ctx.line[ctx.len] = '\0';
+                console_exec(ctx.line);
+                ctx.len = 0;
+                console_echo(CONSOLE_PROMPT, sizeof(CONSOLE_PROMPT) - 1);
+                break;
+            case CHAR_BS:
+            case CHAR_DEL:
+                if (ctx.len) {
+                    ctx.len--;
+                    console_echo("\b \b", 3);
+                }
+                break;
+            case CHAR_CTRL_C:
+            case CHAR_CTRL_U:
+                while (ctx.len) {
+                    ctx.len--;
+                    console_echo("\b \b", 3);
+                }
+                break;
+            default:
+                // Printable characters only, the last slot holds the terminator
+                if ((c >= ' ') && (c < CHAR_DEL) &&
+                    (ctx.len < (CONSOLE_LINE_SIZE - 1))) {
+                    ctx.line[ctx.len++] = c;
+                    console_echo(&c, 1);
+                }
+                break;
+        }
+    }
+}
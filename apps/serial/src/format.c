@@ -0,0 +1,740 @@
+/**
+ ********************************************************************************
+ * @file    format.c
+ * @author  prashanth kannan
+ * @date    2/28/24
+ * @brief   allocation free printf formatting engine
+ ********************************************************************************
+ */
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "stdint.h"
+#include "stdbool.h"
+#include "stddef.h"
+#include "stdarg.h"
+#include "stdio.h"
+#include "string.h"
+
+// APPS
+#include "format.h"
+
+/************************************
+ * EXTERN VARIABLES
+ ************************************/
+
+/************************************
+ * PRIVATE MACROS AND DEFINES
+ ************************************/
+// Conversion flags
+#define FMT_LEFT            (1U << 0)
+#define FMT_PLUS            (1U << 1)
+#define FMT_SPACE           (1U << 2)
+#define FMT_ALT             (1U << 3)
+#define FMT_ZERO            (1U << 4)
+#define FMT_PREC            (1U << 6)
+
+// Widest conversion is a 64-bit octal, 22 digits, or a %f with a 20 digit
+// integer part, the point and FMT_FLOAT_PREC_MAX digits
+#define FMT_NUM_SIZE        (32U)
+#define FMT_FLOAT_PREC_MAX  (9U)
+#define FMT_PAD_SIZE        (16U)
+
+// val / 100 for any 32-bit val, a multiply high instead of a divide
+#define FMT_DIV100(val)     ((uint32_t)(((uint64_t)(val) * 0x51EB851FU) >> 37))
+
+#define MIN(a, b)           ((a) < (b) ? (a) : (b))
+
+/************************************
+ * PRIVATE TYPEDEFS
+ ************************************/
+enum fmt_len {
+    FMT_LEN_INT,
+    FMT_LEN_CHAR,
+    FMT_LEN_SHORT,
+    FMT_LEN_LONG,
+    FMT_LEN_LLONG,
+    FMT_LEN_INTMAX,
+    FMT_LEN_SIZE,
+    FMT_LEN_PTRDIFF,
+};
+
+struct fmt_spec {
+    uint32_t flags;
+    uint32_t width;
+    uint32_t prec;
+    enum fmt_len len;
+};
+
+// Piece of a conversion body, a NULL buf stands for len zeros
+struct fmt_seg {
+    const char *buf;
+    uint32_t len;
+};
+
+struct fmt_buf {
+    char *buf;
+    size_t size;
+    size_t n;
+};
+
+/************************************
+ * STATIC VARIABLES
+ ************************************/
+static const char digit_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static const char hex_lower[] = "0123456789abcdef";
+static const char hex_upper[] = "0123456789ABCDEF";
+
+static const char pad_space[FMT_PAD_SIZE] = "                ";
+static const char pad_zero[FMT_PAD_SIZE] = "0000000000000000";
+
+#if FMT_FLOAT_EN
+static const uint32_t pow10[FMT_FLOAT_PREC_MAX + 1] = {
+    1U, 10U, 100U, 1000U, 10000U, 100000U, 1000000U, 10000000U,
+    100000000U, 1000000000U,
+};
+#endif
+
+/************************************
+ * GLOBAL VARIABLES
+ ************************************/
+
+/************************************
+ * STATIC FUNCTION PROTOTYPES
+ ************************************/
+
+/************************************
+ * STATIC FUNCTIONS
+ ************************************/
+static inline uint32_t fmt_arg32(struct fmt_args *args)
+{
+    if (!args->argc) {
+        return 0;
+    }
+    args->argc--;
+
+    return *args->argv++;
+}
+
+static inline uint64_t fmt_arg64(struct fmt_args *args)
+{
+    uint64_t lo = fmt_arg32(args);
+
+    return lo | ((uint64_t)fmt_arg32(args) << 32);
+}
+
+/*
+ * Fetch an integer argument of the given length, sign extended to 64 bits
+ * for signed conversions
+ */
+static uint64_t fmt_next_int(struct fmt_args *args, enum fmt_len len, bool is_signed)
+{
+    uint64_t val;
+
+    if (args->va) {
+        switch (len) {
+            case FMT_LEN_LONG:
+                val = is_signed ? (uint64_t)va_arg(*args->va, long) :
+                    va_arg(*args->va, unsigned long);
+                break;
+            case FMT_LEN_LLONG:
+                val = is_signed ? (uint64_t)va_arg(*args->va, long long) :
+                    va_arg(*args->va, unsigned long long);
+                break;
+            case FMT_LEN_INTMAX:
+                val = is_signed ? (uint64_t)va_arg(*args->va, intmax_t) :
+                    va_arg(*args->va, uintmax_t);
+                break;
+            case FMT_LEN_SIZE:
+                val = va_arg(*args->va, size_t);
+                if (is_signed && (sizeof(size_t) < sizeof(uint64_t))) {
+                    val = (uint64_t)(int64_t)(int32_t)val;
+                }
+                break;
+            case FMT_LEN_PTRDIFF:
+                val = (uint64_t)va_arg(*args->va, ptrdiff_t);
+                break;
+            default:
+                val = is_signed ? (uint64_t)va_arg(*args->va, int) :
+                    va_arg(*args->va, unsigned int);
+                break;
+        }
+    } else if ((len == FMT_LEN_LLONG) || (len == FMT_LEN_INTMAX)) {
+        return fmt_arg64(args);
+    } else {
+        val = fmt_arg32(args);
+        if (is_signed) {
+            val = (uint64_t)(int64_t)(int32_t)val;
+        }
+    }
+
+    // Promoted char and short arguments are truncated back
+    switch (len) {
+        case FMT_LEN_CHAR:
+            val = is_signed ? (uint64_t)(int64_t)(signed char)val : (unsigned char)val;
+            break;
+        case FMT_LEN_SHORT:
+            val = is_signed ? (uint64_t)(int64_t)(short)val : (unsigned short)val;
+            break;
+        default:
+            break;
+    }
+
+    return val;
+}
+
+static inline uintptr_t fmt_next_ptr(struct fmt_args *args)
+{
+    if (args->va) {
+        return (uintptr_t)va_arg(*args->va, void *);
+    }
+
+    return fmt_arg32(args);
+}
+
+/*
+ * Decimal digits of a 32-bit value written backwards from end, two digits per
+ * step out of the digit pair table
+ */
+static char *fmt_u32_dec(char *end, uint32_t val)
+{
+    while (val >= 100U) {
+        uint32_t q = FMT_DIV100(val);
+        uint32_t r = val - (q * 100U);
+
+        end -= 2;
+        memcpy(end, &digit_pairs[r * 2U], 2);
+        val = q;
+    }
+
+    if (val >= 10U) {
+        end -= 2;
+        memcpy(end, &digit_pairs[val * 2U], 2);
+    } else {
+        *--end = (char)('0' + val);
+    }
+
+    return end;
+}
+
+/*
+ * 64-bit values are split into 9 digit chunks so only the part above 32 bits
+ * ever goes through the library 64-bit divide
+ */
+static char *fmt_u64_dec(char *end, uint64_t val)
+{
+    while (val > UINT32_MAX) {
+        uint64_t q = val / 1000000000U;
+        char *start = fmt_u32_dec(end, (uint32_t)(val - (q * 1000000000U)));
+
+        end -= 9;
+        while (start > end) {
+            *--start = '0';
+        }
+        val = q;
+    }
+
+    return fmt_u32_dec(end, (uint32_t)val);
+}
+
+// Hex and octal digits, shift and mask only
+static char *fmt_u64_pow2(char *end, uint64_t val, uint32_t shift, bool is_upper)
+{
+    const char *digits = is_upper ? hex_upper : hex_lower;
+    uint32_t mask = (1U << shift) - 1U;
+
+    do {
+        *--end = digits[(uint32_t)val & mask];
+        val >>= shift;
+    } while (val);
+
+    return end;
+}
+
+static void fmt_pad(fmt_out_t out, void *arg, const char *pad, uint32_t count)
+{
+    while (count) {
+        uint32_t len = MIN(count, FMT_PAD_SIZE);
+
+        out(arg, pad, len);
+        count -= len;
+    }
+}
+
+/*
+ * Emit one conversion: prefix (sign, 0x), the body segments and the width
+ * padding on whichever side the flags ask for. Returns the characters emitted.
+ */
+static uint32_t fmt_field(fmt_out_t out, void *arg, const struct fmt_spec *spec,
+    const char *prefix, uint32_t prefix_len, const struct fmt_seg *seg, uint32_t nseg)
+{
+    uint32_t len = prefix_len;
+    uint32_t pad;
+
+    for (uint32_t i = 0; i < nseg; i++) {
+        len += seg[i].len;
+    }
+    pad = (spec->width > len) ? (spec->width - len) : 0;
+
+    if (!out) {
+        return len + pad;
+    }
+
+    if (!(spec->flags & FMT_LEFT) && !(spec->flags & FMT_ZERO)) {
+        fmt_pad(out, arg, pad_space, pad);
+    }
+    if (prefix_len) {
+        out(arg, prefix, prefix_len);
+    }
+    if (!(spec->flags & FMT_LEFT) && (spec->flags & FMT_ZERO)) {
+        fmt_pad(out, arg, pad_zero, pad);
+    }
+    for (uint32_t i = 0; i < nseg; i++) {
+        if (!seg[i].buf) {
+            fmt_pad(out, arg, pad_zero, seg[i].len);
+        } else if (seg[i].len) {
+            out(arg, seg[i].buf, seg[i].len);
+        }
+    }
+    if (spec->flags & FMT_LEFT) {
+        fmt_pad(out, arg, pad_space, pad);
+    }
+
+    return len + pad;
+}
+
+static uint32_t fmt_sign(char *prefix, const struct fmt_spec *spec, bool is_neg)
+{
+    if (is_neg) {
+        prefix[0] = '-';
+    } else if (spec->flags & FMT_PLUS) {
+        prefix[0] = '+';
+    } else if (spec->flags & FMT_SPACE) {
+        prefix[0] = ' ';
+    } else {
+        return 0;
+    }
+
+    return 1;
+}
+
+static uint32_t fmt_int(fmt_out_t out, void *arg, struct fmt_spec *spec,
+    char conv, struct fmt_args *args)
+{
+    char num[FMT_NUM_SIZE];
+    char *end = &num[FMT_NUM_SIZE];
+    char *start;
+    char prefix[2];
+    uint32_t prefix_len = 0;
+    uint32_t digits;
+    uint32_t zeros = 0;
+    bool is_signed = (conv == 'd') || (conv == 'i');
+    uint64_t val = fmt_next_int(args, spec->len, is_signed);
+
+    if (is_signed) {
+        bool is_neg = ((int64_t)val < 0);
+
+        if (is_neg) {
+            val = 0U - val;
+        }
+        prefix_len = fmt_sign(prefix, spec, is_neg);
+    }
+
+    switch (conv) {
+        case 'x':
+        case 'X':
+            start = fmt_u64_pow2(end, val, 4, conv == 'X');
+            if ((spec->flags & FMT_ALT) && val) {
+                prefix[0] = '0';
+                prefix[1] = conv;
+                prefix_len = 2;
+            }
+            break;
+        case 'o':
+            start = fmt_u64_pow2(end, val, 3, false);
+            break;
+        default:
+            start = fmt_u64_dec(end, val);
+            break;
+    }
+    digits = end - start;
+
+    // An explicit precision is the minimum digit count and disables the 0 flag
+    if (spec->flags & FMT_PREC) {
+        spec->flags &= ~FMT_ZERO;
+        if (!spec->prec && !val) {
+            digits = 0;
+        }
+        zeros = (spec->prec > digits) ? (spec->prec - digits) : 0;
+    }
+
+    // Alternate octal always starts with a 0
+    if ((conv == 'o') && (spec->flags & FMT_ALT) && !zeros &&
+        (!digits || (*start != '0'))) {
+        zeros = 1;
+    }
+
+    struct fmt_seg seg[] = { { NULL, zeros }, { start, digits } };
+
+    return fmt_field(out, arg, spec, prefix, prefix_len, seg, 2);
+}
+
+#if FMT_FLOAT_EN
+static uint32_t fmt_float(fmt_out_t out, void *arg, struct fmt_spec *spec,
+    char conv, struct fmt_args *args)
+{
+    char num[FMT_NUM_SIZE];
+    char *end = &num[FMT_NUM_SIZE];
+    char *dot;
+    char *start;
+    char prefix[1];
+    uint32_t prefix_len;
+    uint32_t prec = (spec->flags & FMT_PREC) ? spec->prec : 6U;
+    uint32_t extra = 0;
+    uint32_t scale = 0;
+    double val;
+
+    if (args->va) {
+        val = va_arg(*args->va, double);
+    } else {
+        union { uint64_t u; double d; } bits = { .u = fmt_arg64(args) };
+
+        val = bits.d;
+    }
+
+    prefix_len = fmt_sign(prefix, spec, (val < 0) || ((val == 0) && ((1.0 / val) < 0)));
+    if (val < 0) {
+        val = -val;
+    }
+
+    // NaN and infinity, never zero padded
+    if ((val != val) || (val > 1.7976931348623157e308)) {
+        struct fmt_seg seg = {
+            (val != val) ? ((conv == 'F') ? "NAN" : "nan") :
+                ((conv == 'F') ? "INF" : "inf"), 3 };
+
+        spec->flags &= ~FMT_ZERO;
+        return fmt_field(out, arg, spec, prefix, prefix_len, &seg, 1);
+    }
+
+    // Digits past what a double holds are emitted as zeros
+    if (prec > FMT_FLOAT_PREC_MAX) {
+        extra = prec - FMT_FLOAT_PREC_MAX;
+        prec = FMT_FLOAT_PREC_MAX;
+    }
+
+    // Integer parts beyond 64 bits are scaled down and the dropped digits,
+    // which are below double precision anyway, go out as zeros
+    while (val >= 1.8e19) {
+        val /= 10.0;
+        scale++;
+    }
+
+    uint64_t ipart = (uint64_t)val;
+    double rem = (val - (double)ipart) * pow10[prec];
+    uint32_t fpart = (uint32_t)rem;
+
+    // Round half up, carrying into the integer part
+    if (!scale && ((rem - fpart) >= 0.5)) {
+        if (++fpart >= pow10[prec]) {
+            fpart = 0;
+            ipart++;
+        }
+    }
+    if (scale) {
+        fpart = 0;
+    }
+
+    dot = end;
+    if (prec) {
+        dot = fmt_u32_dec(end, fpart);
+        while ((uint32_t)(end - dot) < prec) {
+            *--dot = '0';
+        }
+    }
+    if (prec || (spec->flags & FMT_ALT)) {
+        *--dot = '.';
+    }
+    start = fmt_u64_dec(dot, ipart);
+
+    struct fmt_seg seg[] = {
+        { start, dot - start },
+        { NULL, scale },
+        { dot, end - dot },
+        { NULL, extra },
+    };
+
+    return fmt_field(out, arg, spec, prefix, prefix_len, seg, 4);
+}
+#endif
+
+static uint32_t fmt_str(fmt_out_t out, void *arg, struct fmt_spec *spec,
+    struct fmt_args *args)
+{
+    const char *str = (const char *)fmt_next_ptr(args);
+    uint32_t len = 0;
+
+    if (!str) {
+        str = "(null)";
+    }
+
+    // Precision bounds the read, the string does not need a terminator
+    if (spec->flags & FMT_PREC) {
+        while ((len < spec->prec) && str[len]) {
+            len++;
+        }
+    } else {
+        len = strlen(str);
+    }
+
+    struct fmt_seg seg = { str, len };
+
+    spec->flags &= ~FMT_ZERO;
+    return fmt_field(out, arg, spec, NULL, 0, &seg, 1);
+}
+
+static uint32_t fmt_parse_num(const char **format)
+{
+    uint32_t val = 0;
+
+    while ((**format >= '0') && (**format <= '9')) {
+        val = (val * 10U) + (uint32_t)(*(*format)++ - '0');
+    }
+
+    return val;
+}
+
+static int32_t fmt_star(struct fmt_args *args)
+{
+    return args->va ? va_arg(*args->va, int) : (int32_t)fmt_arg32(args);
+}
+
+static void fmt_buf_out(void *arg, const char *buf, size_t len)
+{
+    struct fmt_buf *out = arg;
+
+    if (out->n < out->size) {
+        size_t copy_len = MIN(len, out->size - out->n);
+
+        memcpy(&out->buf[out->n], buf, copy_len);
+    }
+    out->n += len;
+}
+
+/************************************
+ * GLOBAL FUNCTIONS
+ ************************************/
+/*
+ * Format into the out sink. A NULL sink only counts, which lets callers size
+ * a buffer before the real pass. Returns the number of characters produced.
+ */
+int fmt_format(fmt_out_t out, void *arg, const char *format, struct fmt_args *args)
+{
+    uint32_t n = 0;
+
+    while (*format) {
+        const char *lit = format;
+
+        while (*format && (*format != '%')) {
+            format++;
+        }
+        if (format != lit) {
+            if (out) {
+                out(arg, lit, format - lit);
+            }
+            n += format - lit;
+        }
+        if (!*format) {
+            break;
+        }
+
+        // Flags, width, precision and length
+        const char *conv_start = format++;
+        struct fmt_spec spec = { 0 };
+        bool more = true;
+
+        while (more) {
+            switch (*format) {
+                case '-': spec.flags |= FMT_LEFT; format++; break;
+                case '+': spec.flags |= FMT_PLUS; format++; break;
+                case ' ': spec.flags |= FMT_SPACE; format++; break;
+                case '#': spec.flags |= FMT_ALT; format++; break;
+                case '0': spec.flags |= FMT_ZERO; format++; break;
+                default: more = false; break;
+            }
+        }
+
+        if (*format == '*') {
+            int32_t width = fmt_star(args);
+
+            format++;
+            if (width < 0) {
+                spec.flags |= FMT_LEFT;
+                width = -width;
+            }
+            spec.width = (uint32_t)width;
+        } else {
+            spec.width = fmt_parse_num(&format);
+        }
+
+        if (*format == '.') {
+            format++;
+            spec.flags |= FMT_PREC;
+            if (*format == '*') {
+                int32_t prec = fmt_star(args);
+
+                format++;
+                if (prec < 0) {
+                    spec.flags &= ~FMT_PREC;
+                } else {
+                    spec.prec = (uint32_t)prec;
+                }
+            } else {
+                spec.prec = fmt_parse_num(&format);
+            }
+        }
+
+        switch (*format) {
+            case 'h':
+                format++;
+                spec.len = FMT_LEN_SHORT;
+                if (*format == 'h') {
+                    format++;
+                    spec.len = FMT_LEN_CHAR;
+                }
+                break;
+            case 'l':
+                format++;
+                spec.len = FMT_LEN_LONG;
+                if (*format == 'l') {
+                    format++;
+                    spec.len = FMT_LEN_LLONG;
+                }
+                break;
+            case 'j': format++; spec.len = FMT_LEN_INTMAX; break;
+            case 'z': format++; spec.len = FMT_LEN_SIZE; break;
+            case 't': format++; spec.len = FMT_LEN_PTRDIFF; break;
+            default: break;
+        }
+
+        if (spec.flags & FMT_LEFT) {
+            spec.flags &= ~FMT_ZERO;
+        }
+
+        switch (*format) {
+            case 'd':
+            case 'i':
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+                n += fmt_int(out, arg, &spec, *format, args);
+                break;
+            case 'p':
+                {
+                    struct fmt_args ptr = { .argv = NULL };
+                    uint32_t word = (uint32_t)fmt_next_ptr(args);
+
+                    // Pointers print as %#x, fetched once as a 32-bit word
+                    ptr.argv = &word;
+                    ptr.argc = 1;
+                    spec.flags |= FMT_ALT;
+                    spec.len = FMT_LEN_INT;
+                    n += fmt_int(out, arg, &spec, 'x', &ptr);
+                }
+                break;
+            case 'c':
+                {
+                    char c = (char)(args->va ? va_arg(*args->va, int) :
+                        (int)fmt_arg32(args));
+                    struct fmt_seg seg = { &c, 1 };
+
+                    spec.flags &= ~FMT_ZERO;
+                    n += fmt_field(out, arg, &spec, NULL, 0, &seg, 1);
+                }
+                break;
+            case 's':
+                n += fmt_str(out, arg, &spec, args);
+                break;
+#if FMT_FLOAT_EN
+            case 'f':
+            case 'F':
+                n += fmt_float(out, arg, &spec, *format, args);
+                break;
+#endif
+            case '%':
+                if (out) {
+                    out(arg, "%", 1);
+                }
+                n++;
+                break;
+            default:
+                // Unsupported conversions are copied through as written
+                if (*format) {
+                    format++;
+                }
+                if (out) {
+                    out(arg, conv_start, format - conv_start);
+                }
+                n += format - conv_start;
+                continue;
+        }
+        format++;
+    }
+
+    return (int)n;
+}
+
+/*
+ * Bounded format into buf, always terminated when size is not 0. Returns the
+ * length the full output would have, like vsnprintf.
+ */
+int fmt_snformat(char *buf, size_t size, const char *format, struct fmt_args *args)
+{
+    struct fmt_buf out = { .buf = buf, .size = size ? (size - 1U) : 0 };
+    int n = fmt_format(fmt_buf_out, &out, format, args);
+
+    if (size) {
+        buf[MIN(out.n, out.size)] = '\0';
+    }
+
+    return n;
+}
+
+int vsnprintf(char *buf, size_t size, const char *format, va_list va)
+{
+    va_list va_args;
+    struct fmt_args args = { .va = &va_args };
+    int n;
+
+    va_copy(va_args, va);
+    n = fmt_snformat(buf, size, format, &args);
+    va_end(va_args);
+
+    return n;
+}
+
+int snprintf(char *buf, size_t size, const char *format, ...)
+{
+    va_list va;
+    struct fmt_args args = { .va = &va };
+    int n;
+
+    va_start(va, format);
+    n = fmt_snformat(buf, size, format, &args);
+    va_end(va);
+
+    return n;
+}
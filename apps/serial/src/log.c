@@ -0,0 +1,110 @@
+/**
+ ********************************************************************************
+ * @file    log.c
+ * @author  prashanth kannan
+ * @date    2/28/24
+ * @brief   leveled, per module filtered logging on top of serial
+ ********************************************************************************
+ */
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "stdint.h"
+#include "string.h"
+
+// APPS
+#include "log.h"
+
+/************************************
+ * EXTERN VARIABLES
+ ************************************/
+
+/************************************
+ * PRIVATE MACROS AND DEFINES
+ ************************************/
+#define LOG_MOD_ALL         ((1UL << LOG_MOD_NUM) - 1U)
+
+/************************************
+ * PRIVATE TYPEDEFS
+ ************************************/
+
+/************************************
+ * STATIC VARIABLES
+ ************************************/
+static const char * const module_names[LOG_MOD_NUM] = {
+    [LOG_MOD_main]   = "main",
+    [LOG_MOD_hbeat]  = "hbeat",
+    [LOG_MOD_serial] = "serial",
+    [LOG_MOD_net]    = "net",
+};
+
+/************************************
+ * GLOBAL VARIABLES
+ ************************************/
+// Everything the build keeps is on until changed at runtime
+volatile uint32_t log_mask[LOG_LEVEL_NUM] = {
+    [LOG_LEVEL_ERROR] = LOG_MOD_ALL,
+    [LOG_LEVEL_WARN]  = LOG_MOD_ALL,
+    [LOG_LEVEL_INFO]  = LOG_MOD_ALL,
+    [LOG_LEVEL_DEBUG] = LOG_MOD_ALL,
+};
+
+/************************************
+ * STATIC FUNCTION PROTOTYPES
+ ************************************/
+
+/************************************
+ * STATIC FUNCTIONS
+ ************************************/
+
+/************************************
+ * GLOBAL FUNCTIONS
+ ************************************/
+/*
+ * Enable the module at level and everything more severe, disable the rest.
+ * LOG_LEVEL_NONE silences it.
+ */
+void log_set_level(uint32_t mod, uint32_t level)
+{
+    if (mod >= LOG_MOD_NUM) {
+        return;
+    }
+
+    for (uint32_t i = LOG_LEVEL_ERROR; i < LOG_LEVEL_NUM; i++) {
+        if (i <= level) {
+            log_mask[i] |= (1UL << mod);
+        } else {
+            log_mask[i] &= ~(1UL << mod);
+        }
+    }
+}
+
+uint32_t log_get_level(uint32_t mod)
+{
+    uint32_t level = LOG_LEVEL_NONE;
+
+    for (uint32_t i = LOG_LEVEL_ERROR; (i < LOG_LEVEL_NUM) && (i <= LOG_LEVEL); i++) {
+        if (log_mask[i] & (1UL << mod)) {
+            level = i;
+        }
+    }
+
+    return level;
+}
+
+const char *log_module_name(uint32_t mod)
+{
+    return (mod < LOG_MOD_NUM) ? module_names[mod] : NULL;
+}
+
+int32_t log_module_find(const char *name)
+{
+    for (uint32_t i = 0; i < LOG_MOD_NUM; i++) {
+        if (!strcmp(name, module_names[i])) {
+            return i;
+        }
+    }
+
+    return -1;
+}
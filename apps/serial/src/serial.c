@@ -13,6 +13,7 @@
 #include "stdint.h"
 #include "stdbool.h"
 #include "stdarg.h"
+#include "stdio.h"
 #include "string.h"
 #include "assert.h"
 
@@ -22,7 +23,13 @@
 
 // OS
 #include "FreeRTOS.h"
-#include "semphr.h"
+#include "task.h"
+#include "stream_buffer.h"
+
+// APPS
+#include "serial.h"
+#include "console.h"
+#include "format.h"
 
 /************************************
  * EXTERN VARIABLES
@@ -33,30 +40,208 @@ extern ARM_DRIVER_USART Driver_USART0;
  * PRIVATE MACROS AND DEFINES
  ************************************/
 #define UART_IRQ_PRIO       (15U)
+// GPDMA interrupt, shared with the dma app which sets the same priority
+#define DMA_IRQ_PRIO        (14U)
+#define UART_MODE           (ARM_USART_MODE_ASYNCHRONOUS | ARM_USART_DATA_BITS_8 | \
+                             ARM_USART_PARITY_NONE | ARM_USART_STOP_BITS_1 | \
+                             ARM_USART_FLOW_CONTROL_NONE)
+
+// Console baud rate, normally set from the build configuration
+#ifndef SERIAL_BAUD
+#define SERIAL_BAUD         (115200U)
+#endif
+
+// UART0 PCLKSEL field in PCLKSEL0
+#define UART0_PCLKSEL_POS   (6U)
+#define UART0_PCLKSEL_MSK   (3UL << UART0_PCLKSEL_POS)
+
 #define TX_BUF_SIZE         (128U)
-#define NUM_BUF_SIZE        (12U)
-#define MAX_TX_LOCK_TIME    (pdMS_TO_TICKS(5))
+// Log ring size, must be a power of 2 and not larger than 32K
+#define LOG_RING_SIZE       (2048U)
+#define LOG_RING_MASK       (LOG_RING_SIZE - 1U)
+
+// Log ring reservation word: [15:0] reserve index, [31:16] writers in flight
+#define LOG_RESV_IDX_MSK    (0xFFFFU)
+#define LOG_RESV_WRITER     (1UL << 16)
+
+// Newest output replayed after a watchdog or hard fault reset, at most
+// LOG_RING_SIZE
+#define LOG_RETAIN_SIZE     (1024U)
+#define LOG_MAGIC           (0x4C4F4731UL)
+#define LOG_FAULT_MAGIC     (0x46415531UL)
+
+// Reset source identification bits
+#define RSID_POR            (1U << 0)
+#define RSID_WDTR           (1U << 2)
+#define RSID_BODR           (1U << 3)
+
+// Deferred ISR log records, depth must be a power of 2. All interrupts share
+// one multi-producer ring rather than a queue each: nested ISRs claim slots
+// with LDREX/STREX, and a single ring keeps the records in time order
+// without merging per-ISR queues.
+#define ISR_LOG_DEPTH       (16U)
+#define ISR_LOG_MASK        (ISR_LOG_DEPTH - 1U)
+
+// Per-task log buffers, handed out to the first TASK_LOG_NUM tasks that log
+// and taken back once a deleted task's records are merged, size must be a
+// power of 2
+#define TASK_LOG_NUM        (4U)
+#define TASK_LOG_SIZE       (256U)
+#define TASK_LOG_MASK       (TASK_LOG_SIZE - 1U)
+#define TASK_LOG_REC_MAX    (TASK_LOG_SIZE - sizeof(struct task_rec))
+#define TASK_LOG_TLS_IDX    (0)
+
+#define SERIAL_TASK_NAME    "serial"
+#define SERIAL_TASK_PRIO    (1U)
+#define SERIAL_STACK_SIZE   (160U)
+
+// Console receive, the driver buffer is recycled once it fills up
+#define RX_BUF_SIZE         (32U)
+#define RX_STREAM_SIZE      (64U)
 
 
 #define MIN(a, b)      ((a) < (b) ? (a) : (b))
 
+// Worst case size of a varint encoded 32-bit value
+#define VARINT_MAX_SIZE     (5U)
+
+// Tokenized records are COBS framed, a code byte ahead and a zero after, so a
+// decoder can start or resync at any zero. Shorter than 254 bytes, a record
+// needs no further code bytes.
+#define TOK_REC_MAX         (TX_BUF_SIZE - 2U)
+_Static_assert(TOK_REC_MAX < 254U, "tokenized record needs one COBS block");
+
+// printf is a call site macro in tokenized mode, this file defines the text one
+#undef printf
+
+// Log lines of this file, records in tokenized mode like any other caller's
+#if defined(SERIAL_LOG_TOKENIZED)
+#define serial_printf(format, ...) \
+    serial_tok_log(SERIAL_TOK_ID(format), SERIAL_STR_MASK(__VA_ARGS__), \
+        SERIAL_ARGV(__VA_ARGS__), SERIAL_NARGS(__VA_ARGS__))
+#else
+#define serial_printf       printf
+#endif
+
 /************************************
  * PRIVATE TYPEDEFS
  ************************************/
+// Registers captured by the hard fault handler for the next boot
+struct log_fault {
+    uint32_t magic;
+    uint32_t pc;
+    uint32_t lr;
+    uint32_t psr;
+    uint32_t cfsr;
+    uint32_t hfsr;
+    uint32_t bfar;
+};
+
+// Survives resets in the noinit section, checked by log_retain on boot
+struct log_ring {
+    uint32_t magic;
+    volatile uint32_t resv;
+    volatile uint16_t commit;
+    volatile uint16_t tail;
+    volatile uint32_t dropped;
+    volatile uint32_t hwm;
+    struct log_fault fault;
+    char buf[LOG_RING_SIZE];
+};
+
+struct isr_rec {
+    const char * volatile format;
+    uint32_t ts;
+    uint32_t argc;
+#if defined(SERIAL_LOG_TOKENIZED)
+    uint32_t str_mask;
+#endif
+    uint32_t argv[ISR_LOG_MAX_ARGS];
+};
+
+struct isr_log {
+    struct isr_rec rec[ISR_LOG_DEPTH];
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    volatile uint32_t dropped;
+};
+
+// Header in front of every record in a task buffer, ts is the DWT cycle count
+struct task_rec {
+    uint32_t ts;
+    uint32_t len;
+};
+
+// Written only by the owning task, read only by the merge in the serial task
+struct task_log {
+    char buf[TASK_LOG_SIZE];
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    volatile uint32_t dropped;
+};
+
+struct task_pool {
+    struct task_log *log;
+    volatile uint32_t count;    // buffers handed out at least once
+    volatile uint32_t orphan;   // bit per buffer of a deleted task
+    volatile uint32_t free;     // bit per orphan buffer merged and reusable
+};
+
+// Ring position of a printf writing straight into its reservation
+struct log_sink {
+    char *ring;
+    uint32_t size;
+    uint32_t idx;
+};
+
 struct tx_ctx {
-    char buf[TX_BUF_SIZE];
-    SemaphoreHandle_t mutex;
-    volatile bool completed;
+    volatile uint32_t busy;
+    volatile bool draining;
+    uint16_t span;
+    uint32_t bytes;
+    uint32_t spans;
+    uint32_t cycles;
+};
+
+struct rx_ctx {
+    StreamBufferHandle_t stream;
+    uint8_t buf[RX_BUF_SIZE];
+    uint32_t consumed;
+    volatile uint32_t dropped;
+};
+
+struct baud_ctx {
+    uint32_t req;
+    uint32_t actual;
 };
 
 struct serial_ctx {
+    struct log_ring *log;
+    struct isr_log isr;
     struct tx_ctx tx;
+    struct rx_ctx rx;
+    struct baud_ctx baud;
+    struct task_pool tasks;
+    TaskHandle_t task;
+    volatile bool merge_held;   // records wait for room in the shared ring
+    volatile uint32_t wake;     // task notified, cleared as it starts a pass
 };
 
 /************************************
  * STATIC VARIABLES
  ************************************/
-static struct serial_ctx ctx;
+// GPDMA can not reach the local SRAM, so the ring lives in the AHB SRAM and
+// UART DMA reads spans straight out of it. It is not cleared on reset so the
+// output leading up to a crash can be replayed on the next boot.
+static struct log_ring log_ring __attribute__((section(".noinit.$RAM2")));
+
+// Kept next to the ring to leave the local SRAM to the OS heap
+static struct task_log task_logs[TASK_LOG_NUM] __attribute__((section(".bss.$RAM2")));
+
+static struct serial_ctx ctx = {
+    .log = &log_ring,
+    .tasks.log = task_logs,
+};
 
 /************************************
  * GLOBAL VARIABLES
@@ -69,83 +254,718 @@ static struct serial_ctx ctx;
 /************************************
  * STATIC FUNCTIONS
  ************************************/
-static inline uint8_t cstrcpy(char *out_buf, uint16_t *out_idx, const char *in_buf, uint32_t len)
+#if defined(SERIAL_LOG_TOKENIZED)
+static inline uint8_t varint_put(uint8_t *buf, uint32_t val)
+{
+    uint8_t n = 0;
+
+    while (val >= 0x80U) {
+        buf[n++] = (uint8_t)(val | 0x80U);
+        val >>= 7;
+    }
+    buf[n++] = (uint8_t)val;
+
+    return n;
+}
+
+/*
+ * COBS frame the record in buf[1..len] in place. buf[0] and each zero byte
+ * are replaced by the distance to the next zero, the delimiter at the end.
+ */
+static uint16_t cobs_frame(uint8_t *buf, uint16_t len)
+{
+    uint16_t next = len + 1U;
+
+    buf[0] = 0;
+    buf[next] = 0;
+    for (int32_t i = len; i >= 0; i--) {
+        if (!buf[i]) {
+            buf[i] = (uint8_t)(next - i);
+            next = (uint16_t)i;
+        }
+    }
+
+    return len + 2U;
+}
+#endif
+
+static inline void atomic_add(volatile uint32_t *val, uint32_t inc)
 {
-    uint16_t copy_len = MIN(len, (TX_BUF_SIZE - *out_idx));
+    while (__STREXW(__LDREXW(val) + inc, val));
+}
 
-    memcpy(&out_buf[*out_idx], in_buf, copy_len);
-    *out_idx = *out_idx + copy_len;
+static inline void atomic_max(volatile uint32_t *val, uint32_t new_val)
+{
+    do {
+        if (__LDREXW(val) >= new_val) {
+            __CLREX();
+            return;
+        }
+    } while (__STREXW(new_val, val));
+}
 
-    return (*out_idx < TX_BUF_SIZE) ? 1 : 0;
+static inline bool tx_lock(void)
+{
+    do {
+        if (__LDREXW(&ctx.tx.busy)) {
+            __CLREX();
+            return false;
+        }
+    } while (__STREXW(1, &ctx.tx.busy));
+
+    return true;
 }
 
-static inline uint8_t cuitoa(char *buf, uint32_t val, uint8_t base, bool is_upper)
+static inline void tx_unlock(void)
+{
+    __DMB();
+    ctx.tx.busy = 0;
+}
+
+/*
+ * Reserve len bytes at the head of the log ring. Any number of producers can
+ * hold a reservation at the same time, the reserved bytes become visible to
+ * the drain only once the last writer in flight has committed.
+ */
+static bool log_reserve(uint16_t len, uint16_t *idx)
 {
-    uint8_t i = 0;
+    uint32_t resv;
+    uint16_t head, used;
 
-    if (!val) {
-        buf[i++] = '0';
-        buf[i] = 0;
+    do {
+        resv = __LDREXW(&ctx.log->resv);
+        head = resv & LOG_RESV_IDX_MSK;
+        used = head - ctx.log->tail;
+
+        if ((uint32_t)used + len > LOG_RING_SIZE) {
+            __CLREX();
+            return false;
+        }
+    } while (__STREXW(((resv & ~LOG_RESV_IDX_MSK) + LOG_RESV_WRITER) |
+        ((uint16_t)(head + len)), &ctx.log->resv));
+
+    atomic_max(&ctx.log->hwm, used + len);
+    *idx = head;
+
+    return true;
+}
+
+static void log_commit(void)
+{
+    uint32_t resv;
+    uint16_t head, commit;
+
+    do {
+        resv = __LDREXW(&ctx.log->resv) - LOG_RESV_WRITER;
+    } while (__STREXW(resv, &ctx.log->resv));
+
+    // Other writers are still filling their slots
+    if (resv & ~LOG_RESV_IDX_MSK) {
+        return;
+    }
+
+    // Publish, but never move the commit index backwards in case a later
+    // writer got in ahead of us
+    head = resv & LOG_RESV_IDX_MSK;
+    do {
+        commit = __LDREXH(&ctx.log->commit);
+        if ((int16_t)(head - commit) <= 0) {
+            __CLREX();
+            return;
+        }
+    } while (__STREXH(head, &ctx.log->commit));
+}
+
+// Copy in and out of a power of 2 sized ring at a free running index
+static void ring_put(char *ring, uint32_t size, uint32_t idx, const void *buf, uint32_t len)
+{
+    uint32_t off = idx & (size - 1U);
+    uint32_t first = MIN(len, size - off);
+
+    memcpy(&ring[off], buf, first);
+    memcpy(ring, (const char *)buf + first, len - first);
+}
+
+static void ring_get(const char *ring, uint32_t size, uint32_t idx, void *buf, uint32_t len)
+{
+    uint32_t off = idx & (size - 1U);
+    uint32_t first = MIN(len, size - off);
+
+    memcpy(buf, &ring[off], first);
+    memcpy((char *)buf + first, ring, len - first);
+}
+
+static inline void log_write(uint16_t idx, const char *buf, uint16_t len)
+{
+    ring_put(ctx.log->buf, LOG_RING_SIZE, idx, buf, len);
+}
+
+/*
+ * Push the next contiguous span of committed bytes to the UART. Only the
+ * holder of the tx lock talks to the driver, everyone else just leaves the
+ * data in the ring for the holder or the send complete callback to pick up.
+ */
+static void serial_drain(void)
+{
+    while (tx_lock()) {
+        uint16_t tail = ctx.log->tail;
+        uint16_t count = ctx.log->commit - tail;
+        uint16_t off = tail & LOG_RING_MASK;
+
+        if (!count) {
+            tx_unlock();
+            // A producer may have committed after the check above and found
+            // the lock taken
+            if (ctx.log->commit == tail) {
+                break;
+            }
+            continue;
+        }
+
+        uint32_t start = DWT->CYCCNT;
+
+        ctx.tx.span = MIN(count, LOG_RING_SIZE - off);
+        ctx.tx.draining = 1;
+        if (ARM_DRIVER_OK != Driver_USART0.Send(&ctx.log->buf[off], ctx.tx.span)) {
+            ctx.tx.draining = 0;
+            tx_unlock();
+            break;
+        }
+        ctx.tx.draining = 0;
+        ctx.tx.cycles += DWT->CYCCNT - start;
+
+        // Send is still in progress, the callback continues from here
+        if (ctx.tx.busy) {
+            break;
+        }
+    }
+}
+
+static void log_sink_out(void *arg, const char *buf, size_t len)
+{
+    struct log_sink *sink = arg;
+
+    ring_put(sink->ring, sink->size, sink->idx, buf, len);
+    sink->idx += len;
+}
+
+// Only the first record after the serial task started its pass notifies
+static inline bool wake_claim(void)
+{
+    do {
+        if (__LDREXW(&ctx.wake)) {
+            __CLREX();
+            return false;
+        }
+    } while (__STREXW(1, &ctx.wake));
+
+    return true;
+}
+
+// Wake the serial task to merge new records, task context
+static void log_wake(void)
+{
+    if (ctx.task && wake_claim()) {
+        xTaskNotifyGive(ctx.task);
+    }
+}
+
+/*
+ * Log buffer of the calling task, taken from the pool on first use. NULL
+ * means write to the shared ring directly: from an ISR, before the scheduler
+ * runs, from the serial task itself, which does the merge, or once the pool
+ * is used up.
+ */
+static struct task_log *task_log_get(void)
+{
+    struct task_log *tl;
+    uint32_t idx, free;
+
+    if ((pdTRUE == xPortIsInsideInterrupt()) ||
+        (xTaskGetSchedulerState() != taskSCHEDULER_RUNNING) ||
+        (xTaskGetCurrentTaskHandle() == ctx.task)) {
+        return NULL;
+    }
+
+    tl = pvTaskGetThreadLocalStoragePointer(NULL, TASK_LOG_TLS_IDX);
+    if (tl) {
+        return tl;
+    }
+
+    // One left by a deleted task first, the pool is not grown for it
+    do {
+        free = __LDREXW(&ctx.tasks.free);
+        if (!free) {
+            __CLREX();
+            break;
+        }
+        idx = __CLZ(__RBIT(free));
+    } while (__STREXW(free & ~(1UL << idx), &ctx.tasks.free));
+
+    while (!free) {
+        idx = __LDREXW(&ctx.tasks.count);
+        if (idx >= TASK_LOG_NUM) {
+            __CLREX();
+            return NULL;
+        }
+        if (!__STREXW(idx + 1, &ctx.tasks.count)) {
+            break;
+        }
+    }
+
+    tl = &ctx.tasks.log[idx];
+    vTaskSetThreadLocalStoragePointer(NULL, TASK_LOG_TLS_IDX, tl);
+
+    return tl;
+}
+
+static bool task_log_reserve(struct task_log *tl, uint32_t len)
+{
+    if ((TASK_LOG_SIZE - (tl->head - tl->tail)) < (sizeof(struct task_rec) + len)) {
+        tl->dropped += len;
+        return false;
+    }
+
+    return true;
+}
+
+// Publish a record whose len bytes are already written past the header
+static void task_log_commit(struct task_log *tl, uint32_t len)
+{
+    struct task_rec rec = { .ts = DWT->CYCCNT, .len = len };
+
+    ring_put(tl->buf, TASK_LOG_SIZE, tl->head, &rec, sizeof(rec));
+    __DMB();
+    tl->head += sizeof(rec) + len;
+    log_wake();
+}
+
+/*
+ * Queue one log record. Tasks go through their own buffer so they never
+ * contend with each other, records too big for it go to the shared ring.
+ */
+static int serial_log(const void *buf, uint32_t len)
+{
+    struct task_log *tl = task_log_get();
+
+    if (!tl || (len > TASK_LOG_REC_MAX)) {
+        return serial_tx(buf, len);
+    }
+
+    if (!len || !task_log_reserve(tl, len)) {
+        return 0;
+    }
+
+    ring_put(tl->buf, TASK_LOG_SIZE, tl->head + sizeof(struct task_rec), buf, len);
+    task_log_commit(tl, len);
+
+    return len;
+}
+
+/*
+ * Format a log line. Short lines go through a stack buffer, anything longer
+ * is measured first and then formatted straight into its ring reservation,
+ * so lines are never truncated to the stack buffer.
+ */
+static int serial_format(const char *format, struct fmt_args *args)
+{
+    char buf[TX_BUF_SIZE];
+    struct fmt_args retry = *args;
+    va_list va;
+    int n;
+
+    if (args->va) {
+        va_copy(va, *args->va);
+        retry.va = &va;
+    }
+
+    n = fmt_snformat(buf, sizeof(buf), format, args);
+    if (n < (int)sizeof(buf)) {
+        n = serial_log(buf, n);
     } else {
-        while (val) {
-            uint8_t d = val % base;
+        struct task_log *tl = task_log_get();
+        struct log_sink sink;
+        uint16_t idx;
 
-            if (d > 9) {
-                d -= 10;
-                buf[i++] = is_upper ? ('A' + d) : ('a' + d);
+        if (tl && (n <= TASK_LOG_REC_MAX)) {
+            if (task_log_reserve(tl, n)) {
+                sink = (struct log_sink){ tl->buf, TASK_LOG_SIZE,
+                    tl->head + sizeof(struct task_rec) };
+                fmt_format(log_sink_out, &sink, format, &retry);
+                task_log_commit(tl, n);
             } else {
-                buf[i++] = '0' + d;
+                n = 0;
             }
-            val /= base;
+        } else if ((n <= LOG_RING_SIZE) && log_reserve(n, &idx)) {
+            sink = (struct log_sink){ ctx.log->buf, LOG_RING_SIZE, idx };
+            fmt_format(log_sink_out, &sink, format, &retry);
+            log_commit();
+            serial_drain();
+        } else {
+            atomic_add(&ctx.log->dropped, n);
+            n = 0;
         }
+    }
+
+    if (args->va) {
+        va_end(va);
+    }
 
-        uint8_t x = 0;
-        uint8_t y = i-1;
+    return n;
+}
 
-        while (x < y) {
-            char tmp = buf[x];
+/*
+ * Claim the next deferred ISR record, nested ISRs simply take the one after.
+ * The record is handed to the serial task once its format pointer is set.
+ */
+static struct isr_rec *isr_log_claim(const uint32_t *argv, uint32_t argc)
+{
+    uint32_t head;
 
-            buf[x++] = buf[y];
-            buf[y--] = tmp;
+    do {
+        head = __LDREXW(&ctx.isr.head);
+        if ((head - ctx.isr.tail) >= ISR_LOG_DEPTH) {
+            __CLREX();
+            atomic_add(&ctx.isr.dropped, 1);
+            return NULL;
         }
-        buf[i] = 0;
+    } while (__STREXW(head + 1, &ctx.isr.head));
+
+    struct isr_rec *rec = &ctx.isr.rec[head & ISR_LOG_MASK];
+
+    rec->ts = DWT->CYCCNT;
+    argc = MIN(argc, ISR_LOG_MAX_ARGS);
+    rec->argc = argc;
+    for (uint32_t i = 0; i < argc; i++) {
+        rec->argv[i] = argv[i];
     }
 
-    return i;
+    return rec;
 }
 
-static inline uint8_t citoa(char *buf, int32_t val)
+/*
+ * Timestamp of the oldest deferred ISR record. A record claimed by an
+ * interrupted ISR holds back the ones after it until its format pointer is
+ * published.
+ */
+static bool isr_log_peek(uint32_t *ts)
 {
-    if (val < 0) {
-        val = -val;
-        buf[0] = '-';
-        return cuitoa(&buf[1], (uint32_t)val, 10, false) + 1;
-    } else {
-        return cuitoa(buf, (uint32_t)val, 10, false);
+    struct isr_rec *rec = &ctx.isr.rec[ctx.isr.tail & ISR_LOG_MASK];
+
+    if (!rec->format) {
+        return false;
     }
+    __DMB();
+    *ts = rec->ts;
+
+    return true;
 }
 
-static void usart_cb(uint32_t event)
+// Expand the oldest deferred ISR record, once isr_log_peek has found one
+static void isr_log_expand(void)
+{
+    struct isr_rec *rec = &ctx.isr.rec[ctx.isr.tail & ISR_LOG_MASK];
+    const char *format = rec->format;
+    uint32_t argv[ISR_LOG_MAX_ARGS];
+    uint32_t argc = rec->argc;
+#if defined(SERIAL_LOG_TOKENIZED)
+    uint32_t str_mask = rec->str_mask;
+#endif
+
+    memcpy(argv, rec->argv, sizeof(argv));
+    rec->format = NULL;
+    __DMB();
+    ctx.isr.tail++;
+
+#if defined(SERIAL_LOG_TOKENIZED)
+    serial_tok_log((uint32_t)format, str_mask, argv, argc);
+#else
+    struct fmt_args args = { .argv = argv, .argc = argc };
+
+    serial_format(format, &args);
+#endif
+}
+
+/*
+ * Buffers of deleted tasks become free once their last record is merged.
+ * The delete hook sets orphan bits in a critical section, so the bits are
+ * moved in one as well.
+ */
+static void task_log_recycle(void)
 {
-    switch (event) {
-        case ARM_USART_EVENT_SEND_COMPLETE:
-            {
-                ctx.tx.completed = 1;
+    uint32_t orphan = ctx.tasks.orphan;
+
+    while (orphan) {
+        uint32_t idx = __CLZ(__RBIT(orphan));
+        struct task_log *tl = &ctx.tasks.log[idx];
+
+        orphan &= ~(1UL << idx);
+        if (tl->head == tl->tail) {
+            taskENTER_CRITICAL();
+            ctx.tasks.orphan &= ~(1UL << idx);
+            ctx.tasks.free |= 1UL << idx;
+            taskEXIT_CRITICAL();
+        }
+    }
+}
+
+/*
+ * Move records into the shared ring oldest first, across the task buffers and
+ * the deferred ISR records. Stops when the ring is full, the task buffers then
+ * hold on to their records until the next send completes.
+ */
+static void log_merge(void)
+{
+    while (1) {
+        struct task_log *next = NULL;
+        struct task_rec best;
+        uint32_t count = ctx.tasks.count;
+        uint32_t isr_ts;
+
+        for (uint32_t i = 0; i < count; i++) {
+            struct task_log *tl = &ctx.tasks.log[i];
+            struct task_rec rec;
+
+            if (tl->head == tl->tail) {
+                continue;
+            }
+            __DMB();
+
+            ring_get(tl->buf, TASK_LOG_SIZE, tl->tail, &rec, sizeof(rec));
+            if (!next || ((int32_t)(rec.ts - best.ts) < 0)) {
+                next = tl;
+                best = rec;
             }
+        }
+
+        if (isr_log_peek(&isr_ts) && (!next || ((int32_t)(isr_ts - best.ts) < 0))) {
+            isr_log_expand();
+            continue;
+        }
+
+        uint16_t idx;
+
+        if (!next) {
             break;
-        default:
+        }
+        // Flag the hold before trying, a send completing in between then
+        // still finds it set and wakes the task
+        ctx.merge_held = true;
+        __DMB();
+        if (!log_reserve(best.len, &idx)) {
             break;
+        }
+        ctx.merge_held = false;
+
+        // Straight from one ring to the other, both sides may wrap
+        uint32_t off = (next->tail + sizeof(best)) & TASK_LOG_MASK;
+        uint32_t first = MIN(best.len, TASK_LOG_SIZE - off);
+
+        log_write(idx, &next->buf[off], first);
+        log_write(idx + first, next->buf, best.len - first);
+        log_commit();
+        __DMB();
+        next->tail += sizeof(best) + best.len;
+
+        serial_drain();
+    }
+
+    task_log_recycle();
+}
+
+/*
+ * Hand the bytes received since the last event over to the serial task. The
+ * driver buffer is restarted once it is full, RX timeouts in between flush
+ * whatever the FIFO held when the line went idle.
+ */
+static void rx_push(bool complete, BaseType_t *woken)
+{
+    uint32_t count = Driver_USART0.GetRxCount();
+
+    if (count > ctx.rx.consumed) {
+        uint32_t len = count - ctx.rx.consumed;
+        uint32_t sent = xStreamBufferSendFromISR(ctx.rx.stream,
+            &ctx.rx.buf[ctx.rx.consumed], len, woken);
+
+        ctx.rx.dropped += len - sent;
+        ctx.rx.consumed = count;
+        if (sent && ctx.task) {
+            vTaskNotifyGiveFromISR(ctx.task, woken);
+        }
+    }
+
+    if (complete) {
+        ctx.rx.consumed = 0;
+        Driver_USART0.Receive(ctx.rx.buf, RX_BUF_SIZE);
+    }
+}
+
+/*
+ * Pick the log ring up from before the reset. After a power on or brown out
+ * the RAM content is undefined and the ring starts over, after a watchdog or
+ * hard fault reset the newest LOG_RETAIN_SIZE bytes are queued for replay,
+ * after any other reset output just carries on.
+ */
+static void log_retain(void)
+{
+    struct log_ring *log = ctx.log;
+    uint32_t rsid = LPC_SC->RSID;
+    bool fault = (log->fault.magic == LOG_FAULT_MAGIC);
+    const char *cause = fault ? "hard fault" : "watchdog";
+
+    LPC_SC->RSID = rsid;
+    log->fault.magic = 0;
+
+    if ((log->magic != LOG_MAGIC) || (rsid & (RSID_POR | RSID_BODR)) ||
+        ((uint16_t)(log->commit - log->tail) > LOG_RING_SIZE)) {
+        memset(log, 0, sizeof(*log));
+        log->magic = LOG_MAGIC;
+        return;
+    }
+
+    // Writes in flight at the reset never got committed, drop them
+    log->resv = log->commit;
+    log->dropped = 0;
+    log->hwm = 0;
+    log->tail = log->commit;
+
+    if (!fault && !(rsid & RSID_WDTR)) {
+        return;
+    }
+
+    // Replay from the oldest retained byte, skipping what was never written
+    // since the ring was cleared
+    uint16_t tail = log->commit - LOG_RETAIN_SIZE;
+
+#if defined(SERIAL_LOG_TOKENIZED)
+    // Start on a record, past the first zero delimiter
+    while ((tail != log->commit) && log->buf[tail & LOG_RING_MASK]) {
+        tail++;
+    }
+#endif
+    while ((tail != log->commit) && !log->buf[tail & LOG_RING_MASK]) {
+        tail++;
+    }
+    log->tail = tail;
+
+    // Queued after the replayed output
+    serial_printf("\r\n--- log retained across %s reset ---\r\n", cause);
+
+    if (fault) {
+        serial_printf("pc %08lx lr %08lx psr %08lx cfsr %08lx hfsr %08lx bfar %08lx\r\n",
+            (unsigned long)log->fault.pc, (unsigned long)log->fault.lr,
+            (unsigned long)log->fault.psr, (unsigned long)log->fault.cfsr,
+            (unsigned long)log->fault.hfsr, (unsigned long)log->fault.bfar);
+    }
+}
+
+/*
+ * Hard fault, entered from HardFault_Handler with the stacked exception
+ * frame. The registers are kept for the next boot, which replays the log.
+ */
+__attribute__((used)) static void log_fault(const uint32_t *frame)
+{
+    struct log_fault *fault = &log_ring.fault;
+
+    fault->pc = frame[6];
+    fault->lr = frame[5];
+    fault->psr = frame[7];
+    fault->cfsr = SCB->CFSR;
+    fault->hfsr = SCB->HFSR;
+    fault->bfar = SCB->BFAR;
+    __DMB();
+    fault->magic = LOG_FAULT_MAGIC;
+
+    NVIC_SystemReset();
+}
+
+/*
+ * Baud rate the UART0 dividers actually produce,
+ * PCLK / (16 * DLM:DLL * (1 + DIVADDVAL / MULVAL))
+ */
+static uint32_t baud_actual(void)
+{
+    static const uint8_t pclk_div[] = { 4, 1, 2, 8 };
+    uint32_t pclk = SystemCoreClock /
+        pclk_div[(LPC_SC->PCLKSEL0 & UART0_PCLKSEL_MSK) >> UART0_PCLKSEL_POS];
+    uint32_t latch;
+    uint32_t add = (LPC_UART0->FDR & USART_FDR_DIVADDVAL_MSK) >> USART_FDR_DIVADDVAL_POS;
+    uint32_t mul = (LPC_UART0->FDR & USART_FDR_MULVAL_MSK) >> USART_FDR_MULVAL_POS;
+
+    LPC_UART0->LCR |= USART_LCR_DLAB;
+    latch = ((uint32_t)LPC_UART0->DLM << 8) | LPC_UART0->DLL;
+    LPC_UART0->LCR &= ~USART_LCR_DLAB;
+
+    if (!latch) {
+        return 0;
+    }
+    if (!add || !mul) {
+        return pclk / (16U * latch);
+    }
+
+    return (uint32_t)(((uint64_t)pclk * mul) / (16ULL * latch * (mul + add)));
+}
+
+static int32_t baud_config(uint32_t baud)
+{
+    int32_t ret = Driver_USART0.Control(UART_MODE, baud);
+
+    if (ret == ARM_DRIVER_OK) {
+        ctx.baud.req = baud;
+        ctx.baud.actual = baud_actual();
+    }
+
+    return ret;
+}
+
+/*
+ * Woken by a notification for console input, new log records and ring space
+ * freed for held back records. The first pass picks up ISR records queued
+ * before the task existed. Clearing wake before the pass lets the next record
+ * after it notify again.
+ */
+static void serial_task(void *arg)
+{
+    uint8_t buf[RX_BUF_SIZE];
+    size_t len;
+
+    while (1) {
+        ctx.wake = 0;
+        __DMB();
+        while ((len = xStreamBufferReceive(ctx.rx.stream, buf, sizeof(buf), 0))) {
+            console_input((const char *)buf, len);
+        }
+        log_merge();
+
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
     }
 }
 
-static void serial_tx(const void *buf, uint32_t len)
+static void usart_cb(uint32_t event)
 {
-    assert(ctx.tx.completed);
-    if (ctx.tx.completed) {
-        ctx.tx.completed = 0;
-        Driver_USART0.Send(buf, len);
-        while(!ctx.tx.completed);
+    BaseType_t woken = pdFALSE;
+
+    if (event & ARM_USART_EVENT_SEND_COMPLETE) {
+        ctx.tx.bytes += ctx.tx.span;
+        ctx.tx.spans++;
+        ctx.log->tail += ctx.tx.span;
+        tx_unlock();
+        // Send can complete synchronously from within serial_drain,
+        // which then loops on its own instead of recursing here
+        if (!ctx.tx.draining) {
+            serial_drain();
+        }
+        if (ctx.merge_held && ctx.task) {
+            ctx.merge_held = false;
+            vTaskNotifyGiveFromISR(ctx.task, &woken);
+        }
+    }
+
+    if (event & (ARM_USART_EVENT_RX_TIMEOUT | ARM_USART_EVENT_RECEIVE_COMPLETE)) {
+        rx_push(event & ARM_USART_EVENT_RECEIVE_COMPLETE, &woken);
     }
+
+    portYIELD_FROM_ISR(woken);
 }
 
 /************************************
@@ -155,126 +975,231 @@ void serial_init(void)
 {
     int32_t ret;
 
-    // Driver initialization
+    // Cycle counter for TX cost accounting
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    // Driver initialization, TX runs on GPDMA when RTE_UART0_DMA_TX_EN is set
     ret = Driver_USART0.Initialize(usart_cb);
     assert(ret == ARM_DRIVER_OK);
 
     NVIC_SetPriority(UART0_IRQn, UART_IRQ_PRIO);
+#if (RTE_UART0_DMA_TX_EN == 1)
+    // Send completions reach usart_cb from the GPDMA interrupt, which must
+    // not run above the FreeRTOS syscall priority whatever else sets it up
+    NVIC_SetPriority(DMA_IRQn, DMA_IRQ_PRIO);
+#endif
     ret = Driver_USART0.PowerControl(ARM_POWER_FULL);
     assert(ret == ARM_DRIVER_OK);
 
-    ret = Driver_USART0.Control(ARM_USART_MODE_ASYNCHRONOUS |
-        ARM_USART_DATA_BITS_8 | ARM_USART_PARITY_NONE |
-        ARM_USART_STOP_BITS_1 | ARM_USART_FLOW_CONTROL_NONE, 112500);
+    ret = baud_config(SERIAL_BAUD);
     assert(ret == ARM_DRIVER_OK);
 
     ret = Driver_USART0.Control(ARM_USART_CONTROL_TX, 1);
     assert(ret == ARM_DRIVER_OK);
 
-    // TX context initialization
-    ctx.tx.mutex = xSemaphoreCreateMutex();
-    assert(ctx.tx.mutex);
-    ctx.tx.completed = 1;
+    // Before anything is logged, the ring may hold output from before a crash
+    log_retain();
+
+    // Console input, the stream must exist before the first RX event
+    ctx.rx.stream = xStreamBufferCreate(RX_STREAM_SIZE, 1);
+    assert(ctx.rx.stream);
+
+    ret = Driver_USART0.Control(ARM_USART_CONTROL_RX, 1);
+    assert(ret == ARM_DRIVER_OK);
+
+    ret = Driver_USART0.Receive(ctx.rx.buf, RX_BUF_SIZE);
+    assert(ret == ARM_DRIVER_OK);
+
+    BaseType_t ok = xTaskCreate(serial_task, SERIAL_TASK_NAME, SERIAL_STACK_SIZE,
+        NULL, SERIAL_TASK_PRIO, &ctx.task);
+    assert(ok);
 }
 
-int printf(const char *format, ...)
+uint32_t serial_tx(const void *buf, uint32_t len)
 {
-    // printf from ISR is not supported
-    if (pdTRUE == xPortIsInsideInterrupt()) {
+    uint16_t idx;
+
+    if (!len || (len > LOG_RING_SIZE)) {
         return 0;
     }
 
-    bool os_running = (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED);
+    if (!log_reserve(len, &idx)) {
+        atomic_add(&ctx.log->dropped, len);
+        return 0;
+    }
 
-    // Protect TX
-    if (os_running) {
-        if (pdFALSE == xSemaphoreTake(ctx.tx.mutex, MAX_TX_LOCK_TIME)) {
-            return 0;
-        }
+    log_write(idx, buf, len);
+    log_commit();
+    serial_drain();
+
+    return len;
+}
+
+/*
+ * Change the console baud rate. Queued output goes out at the old rate first,
+ * on failure the old rate stays in place. Task context only.
+ */
+int32_t serial_set_baud(uint32_t baud)
+{
+    int32_t ret;
+
+    // Hold the tx lock once the ring is empty so no new span starts
+    while ((ctx.log->tail != ctx.log->commit) || !tx_lock()) {
+        serial_drain();
+        vTaskDelay(1);
+    }
+    while (Driver_USART0.GetStatus().tx_busy) {
+        vTaskDelay(1);
     }
 
-    // Process printf
-    uint32_t i = 0;
-    uint16_t n = 0;
-    va_list args;
+    // Receive has to be stopped for the driver to accept a new mode
+    taskENTER_CRITICAL();
+    Driver_USART0.Control(ARM_USART_ABORT_RECEIVE, 0);
+    ret = baud_config(baud);
+    ctx.rx.consumed = 0;
+    Driver_USART0.Receive(ctx.rx.buf, RX_BUF_SIZE);
+    taskEXIT_CRITICAL();
 
-    va_start(args, format);
-    while (format[i]) {
-        const char *str_start;
-        uint32_t str_len;
+    tx_unlock();
+    serial_drain();
 
-        for (str_start = &format[i], str_len = 0; (format[i] && format[i] != '%'); i++, str_len++);
+    return ret;
+}
 
-        if (!cstrcpy(ctx.tx.buf, &n, str_start, str_len)) {
-            break;
-        }
+/*
+ * Requested and achieved baud rate, error in parts per million
+ */
+uint32_t serial_get_baud(uint32_t *actual, int32_t *error_ppm)
+{
+    uint32_t req = ctx.baud.req;
 
-        if (format[i] == '%') {
-            char num[NUM_BUF_SIZE];
-
-            i++;
-            str_start = num;
-
-        decode_format:
-            switch (format[i++]) {
-                case 'd':
-                case 'i':
-                    str_len = citoa(num, va_arg(args, int32_t));
-                    break;
-                case 'u':
-                    str_len = cuitoa(num, va_arg(args, uint32_t), 10, false);
-                    break;
-                case 'x':
-                    str_len = cuitoa(num, va_arg(args, uint32_t), 16, false);
-                    break;
-                case 'X':
-                    str_len = cuitoa(num, va_arg(args, uint32_t), 16, true);
-                    break;
-                case 'c':
-                    num[0] = (char)va_arg(args, int);
-                    str_len = 1;
-                    break;
-                case 's':
-                    str_start = va_arg(args, char*);
-                    str_len = strlen(str_start);
-                    break;
-                case 'p':
-                    str_len = cuitoa(num, va_arg(args, uint32_t), 16, true);
-                    break;
-                case 'l':
-                    switch (format[i]) {
-                        case 'd':
-                        case 'i':
-                        case 'u':
-                        case 'x':
-                        case 'X':
-                            goto decode_format;
-                            break;
-                        default:
-                            assert(0);
-                            break;
-                    }
-                    break;
-                default:
-                    assert(0);
-                    break;
-            }
+    *actual = ctx.baud.actual;
+    *error_ppm = (int32_t)((((int64_t)ctx.baud.actual - req) * 1000000) / req);
 
-            assert(str_start);
-            if (!cstrcpy(ctx.tx.buf, &n, str_start, str_len)) {
-                break;
-            }
+    return req;
+}
+
+void serial_get_stats(struct serial_stats *stats)
+{
+    stats->dropped = ctx.log->dropped;
+    stats->hwm = ctx.log->hwm;
+    stats->isr_dropped = ctx.isr.dropped;
+    stats->tx_bytes = ctx.tx.bytes;
+    stats->tx_spans = ctx.tx.spans;
+    stats->tx_cycles = ctx.tx.cycles;
+    stats->irq_cycles = USART_GetIrqCycles(0);
+    stats->tx_dma = (RTE_UART0_DMA_TX_EN == 1);
+    stats->rx_dropped = ctx.rx.dropped;
+    stats->task_bufs = ctx.tasks.count;
+    stats->task_dropped = 0;
+    for (uint32_t i = 0; i < stats->task_bufs; i++) {
+        stats->task_dropped += ctx.tasks.log[i].dropped;
+    }
+}
+
+/*
+ * traceTASK_DELETE hook, called in a critical section. The buffer of the
+ * task goes back to the pool after the merge has taken its records.
+ */
+void serial_task_deleted(void *task)
+{
+    struct task_log *tl = pvTaskGetThreadLocalStoragePointer((TaskHandle_t)task,
+        TASK_LOG_TLS_IDX);
+
+    if (tl) {
+        ctx.tasks.orphan |= 1UL << (tl - ctx.tasks.log);
+    }
+}
+
+/*
+ * Deferred ISR records are picked up from the tick, so isr_printf makes no
+ * kernel call and works at any interrupt priority
+ */
+void vApplicationTickHook(void)
+{
+    if ((ctx.isr.head != ctx.isr.tail) && ctx.task && wake_claim()) {
+        vTaskNotifyGiveFromISR(ctx.task, NULL);
+    }
+}
+
+void serial_isr_log(const char *format, const uint32_t *argv, uint32_t argc)
+{
+    struct isr_rec *rec = isr_log_claim(argv, argc);
+
+    if (rec) {
+        __DMB();
+        rec->format = format;
+    }
+}
+
+#if defined(SERIAL_LOG_TOKENIZED)
+void serial_isr_tok_log(uint32_t id, uint32_t str_mask, const uint32_t *argv, uint32_t argc)
+{
+    struct isr_rec *rec = isr_log_claim(argv, argc);
+
+    if (rec) {
+        rec->str_mask = str_mask;
+        __DMB();
+        rec->format = (const char *)id;
+    }
+}
+
+int serial_tok_log(uint32_t id, uint32_t str_mask, const uint32_t *argv, uint32_t argc)
+{
+    uint8_t buf[TX_BUF_SIZE];
+    uint8_t *rec = &buf[1];
+    uint16_t n = varint_put(rec, id);
+
+    for (uint32_t i = 0; i < argc; i++) {
+        if (str_mask & (1U << i)) {
+            // Strings go inline with their length, truncated so that the
+            // remaining arguments always fit
+            const char *str = (const char *)argv[i];
+            uint32_t len = MIN(strlen(str),
+                TOK_REC_MAX - n - (argc - i + 1) * VARINT_MAX_SIZE);
+
+            n += varint_put(&rec[n], len);
+            memcpy(&rec[n], str, len);
+            n += len;
+        } else {
+            n += varint_put(&rec[n], argv[i]);
         }
     }
-    va_end(args);
 
-    // Send data out
-    serial_tx(ctx.tx.buf, n);
+    return serial_log(buf, cobs_frame(buf, n));
+}
+#endif
 
-    // Unprotect TX
-    if (os_running) {
-        xSemaphoreGive(ctx.tx.mutex);
+int printf(const char *format, ...)
+{
+    // printf from ISR is not supported, use isr_printf instead
+    if (pdTRUE == xPortIsInsideInterrupt()) {
+        return 0;
     }
 
+    // Queue data for the drain, the caller never waits on the UART
+    va_list va;
+    struct fmt_args args = { .va = &va };
+    int n;
+
+    va_start(va, format);
+    n = serial_format(format, &args);
+    va_end(va);
+
     return n;
 }
+
+/*
+ * Overrides the spinning default handler in the startup code. Picks the stack
+ * the exception frame went to and hands it to log_fault.
+ */
+__attribute__((naked)) void HardFault_Handler(void)
+{
+    __asm volatile (
+        "tst lr, #4     \n"
+        "ite eq         \n"
+        "mrseq r0, msp  \n"
+        "mrsne r0, psp  \n"
+        "b log_fault    \n");
+}
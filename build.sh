@@ -6,6 +6,7 @@ function report_error_and_exit {
     echo "Insufficient or invalid args"
     echo "To build try build.sh compile"
     echo "To clean try build.sh clean"
+    echo "To run the host tests try build.sh test"
     exit -1
 }
 
@@ -25,6 +26,10 @@ case $i in
     CLEAN="true"
     shift
     ;;
+    test)
+    TEST="true"
+    shift
+    ;;
     verbose)
     VERBOSE="true"
     shift
@@ -35,6 +40,15 @@ case $i in
 esac
 done
 
+# Host tests need no cross toolchain
+if [[ $TEST == "true" ]]
+then
+    cmake -S test -B build/test
+    make -C build/test --no-print-directory
+    ctest --test-dir build/test --output-on-failure
+    exit 0
+fi
+
 # Run CMake to generate make files
 cmake -S . -B build
 
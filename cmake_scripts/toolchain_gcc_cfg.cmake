@@ -16,6 +16,51 @@ else()
     message(ERROR "Build type is invalid")
 endif()
 
+# Serial log mode
+# Possible values: text / tokenized
+set(SERIAL_LOG_MODE "text")
+if (${SERIAL_LOG_MODE} STREQUAL "tokenized")
+    message("Tokenized serial log is active")
+    set(C_FLAGS "${C_FLAGS} -DSERIAL_LOG_TOKENIZED")
+endif()
+
+# Serial log level, LOG_* calls above it are compiled out
+# Possible values: none / error / warn / info / debug
+set(SERIAL_LOG_LEVEL "info")
+set(SERIAL_LOG_LEVELS none error warn info debug)
+list(FIND SERIAL_LOG_LEVELS ${SERIAL_LOG_LEVEL} SERIAL_LOG_LEVEL_NUM)
+if (${SERIAL_LOG_LEVEL_NUM} EQUAL -1)
+    message(ERROR "Serial log level is invalid")
+endif()
+set(C_FLAGS "${C_FLAGS} -DLOG_LEVEL=${SERIAL_LOG_LEVEL_NUM}")
+
+# Serial console baud rate, can be changed at runtime with serial_set_baud
+# From the 100 MHz UART0 PCLK: standard rates up to 1500000 through the
+# fractional divider, 1562500 / 3125000 / 6250000 with exact integer dividers
+set(SERIAL_BAUD "115200")
+set(C_FLAGS "${C_FLAGS} -DSERIAL_BAUD=${SERIAL_BAUD}")
+
+# GPDMA copy benchmark on the console 'dma bench' command, takes 8K of AHB SRAM
+# Possible values: on / off
+set(DMA_BENCH "off")
+if (${DMA_BENCH} STREQUAL "on")
+    set(C_FLAGS "${C_FLAGS} -DDMA_BENCH")
+endif()
+
+# Static IPv4 setup of the net app, dotted quads
+set(NET_IP_ADDR "192.168.1.50")
+set(NET_NETMASK "255.255.255.0")
+set(NET_GATEWAY "192.168.1.1")
+foreach(NET_CFG NET_IP_ADDR NET_NETMASK NET_GATEWAY)
+    string(REPLACE "." "," NET_CFG_PARTS ${${NET_CFG}})
+    set(C_FLAGS "${C_FLAGS} -D${NET_CFG}=${NET_CFG_PARTS}")
+endforeach()
+
+# Frames the net task reads per poll with the EMAC Rx interrupt masked,
+# 0 takes an interrupt for every burst of frames
+set(NET_RX_BUDGET "16")
+set(C_FLAGS "${C_FLAGS} -DNET_RX_BUDGET=${NET_RX_BUDGET}")
+
 # Linker script
 set(LINKER_SCRIPT_DIR "${CMAKE_CURRENT_LIST_DIR}/../linker_scripts")
 set(LINKER_SCRIPT "${LINKER_SCRIPT_DIR}/${TARGET_MEM}.ld")
@@ -109,7 +109,7 @@
 
 // <e> ENET (Ethernet Interface) [Driver_ETH_MAC0]
 // <i> Configuration settings for Driver_ETH_MAC0 in component ::Drivers:Ethernet MAC
-#define RTE_ENET                        0
+#define RTE_ENET                        1
 
 
 //   <h> RMII (Reduced Media Independent Interface)
@@ -347,11 +347,15 @@
 //   <h> DMA
 //     <e> Tx
 //       <o1> Channel     <0=>0 <1=>1 <2=>2 <3=>3 <4=>4 <5=>5 <6=>6 <7=>7
+//                        <128=>Pool high <129=>Pool medium <130=>Pool low
+//       <i> Pool channels are taken from the GPDMA channel pool per transfer
 //     </e>
-#define   RTE_UART0_DMA_TX_EN           0
-#define   RTE_UART0_DMA_TX_CH           0
+#define   RTE_UART0_DMA_TX_EN           1
+#define   RTE_UART0_DMA_TX_CH           128
 //     <e> Rx
 //       <o1> Channel    <0=>0 <1=>1 <2=>2 <3=>3 <4=>4 <5=>5 <6=>6 <7=>7
+//                       <128=>Pool high <129=>Pool medium <130=>Pool low
+//       <i> Pool channels are taken from the GPDMA channel pool per transfer
 //     </e>
 #define   RTE_UART0_DMA_RX_EN           0
 #define   RTE_UART0_DMA_RX_CH           1
@@ -0,0 +1,27 @@
+/* --------------------------------------------------------------------------
+ * $Date:        17. October 2026
+ * $Revision:    V1.0
+ *
+ * Project:      CRC-32 (IEEE 802.3) Definitions
+ * -------------------------------------------------------------------------- */
+
+#ifndef __CRC32_H
+#define __CRC32_H
+
+#include <stdint.h>
+
+// Initial value for a new CRC32_Update sequence
+#define CRC32_INIT                         (0x00000000U)
+
+/**
+  \fn          uint32_t CRC32_Update (uint32_t crc, const void *data, uint32_t len)
+  \brief       Calculate 32-bit CRC (Polynom: 0x04C11DB7, reflected, as used by
+               Ethernet, zlib and PNG).
+  \param[in]   crc   CRC of the preceding data, \ref CRC32_INIT for the first block
+  \param[in]   data  Pointer to buffer containing the data
+  \param[in]   len   Data length in bytes
+  \returns     CRC of all data so far, "123456789" gives 0xCBF43926
+*/
+extern uint32_t CRC32_Update (uint32_t crc, const void *data, uint32_t len);
+
+#endif // __CRC32_H
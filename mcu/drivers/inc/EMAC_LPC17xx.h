@@ -17,8 +17,8 @@
  * limitations under the License.
  *
  *
- * $Date:        10. Januar 2020
- * $Revision:    V2.13
+ * $Date:        17. October 2026
+ * $Revision:    V2.30
  *
  * Project:      Ethernet Media Access (MAC) Definitions for NXP LPC17xx
  * -------------------------------------------------------------------------- */
@@ -63,6 +63,9 @@
 /* EMAC Driver state flags */
 #define EMAC_FLAG_INIT      (1U << 0)       // Driver initialized
 #define EMAC_FLAG_POWER     (1U << 1)       // Driver power on
+#define EMAC_FLAG_CSUM_RX   (1U << 2)       // Receive checksum offload
+#define EMAC_FLAG_CSUM_TX   (1U << 3)       // Transmit checksum offload
+#define EMAC_FLAG_RX_POLL   (1U << 4)       // Receive interrupt masks itself
 
 /* MAC Configuration Register 1 */
 #define MAC1_REC_EN         0x00000001U     // Receive Enable
@@ -329,14 +332,182 @@ typedef struct {
   uint32_t volatile Info;                   // Transmit status return flags
 } TX_Stat;
 
+/**
+  \fn          void EMAC_TxRelease_t (const uint8_t *frame)
+  \brief       Signal that EMAC is done with a buffer loaned by \ref EMAC_TxFrameLoan.
+               Called from ENET_IRQHandler.
+  \param[in]   frame  Frame buffer address as passed to \ref EMAC_TxFrameLoan
+  \return      none
+*/
+typedef void (*EMAC_TxRelease_t) (const uint8_t *frame);
+
 /* EMAC Driver Control Information */
 typedef struct {
   ARM_ETH_MAC_SignalEvent_t cb_event;       // Event callback
   bool              dev_175x;               // Small LPC175x device
-  uint8_t           reserved[2];            // Reserved
+  uint8_t           tx_done;                // First Tx descriptor not reclaimed
+  uint8_t           tx_frags;               // Tx descriptors of the frame being built
   uint8_t           flags;                  // Control and state flags
+  bool              mii_read;               // MII read started, result not taken
+  uint16_t          mii_data;               // Last MII read result
   uint8_t          *frame_end;              // End of assembled frame fragments
   uint32_t          frame_len;              // Frame length
+  uint32_t          frame_sum;              // Checksum partial sum of the assembled frame
+  EMAC_TxRelease_t  tx_release;             // Loaned Tx buffer release callback
 } EMAC_CTRL;
 
+/* EMAC Statistics, wrap around */
+typedef struct {
+  uint32_t rx_frames;                       // Frames received and handed out
+  uint32_t rx_bytes;                        // Bytes of those frames
+  uint32_t rx_crc_err;                      // Frames with CRC, symbol or alignment error
+  uint32_t rx_overrun;                      // Frames cut by a receive FIFO overrun
+  uint32_t rx_dropped;                      // Other frames dropped: length, filter, checksum, group
+  uint32_t rx_ring_full;                    // Rx ring used up (RxFinished, RxOverrun interrupts)
+  uint32_t rx_ring_hwm;                     // Most frames waiting in the Rx ring
+  uint32_t tx_frames;                       // Frames sent
+  uint32_t tx_bytes;                        // Bytes sent
+  uint32_t tx_errors;                       // Frames aborted: collisions, underrun
+  uint32_t tx_busy;                         // Sends refused with all Tx descriptors in use
+  uint32_t tx_ring_hwm;                     // Most Tx descriptors in use
+  uint32_t hash_pass;                       // Multicast frames passed by the hash filter
+  uint32_t hash_drop;                       // Of those, frames of groups not joined
+} EMAC_STATS;
+
+/**
+  \fn          int32_t EMAC_RxFrameLoan (uint8_t **frame)
+  \brief       Take the received frame buffer instead of copying it with ReadFrame.
+               A spare buffer takes its place in the Rx descriptor, so the
+               frame stays valid until it is given back.
+  \param[out]  frame  Pointer where the frame buffer address is written to
+  \returns
+   - \b  >0: frame length in bytes, return the buffer with \ref EMAC_RxFrameReturn
+   - \b   0: no frame received
+   - \b  ARM_DRIVER_ERROR: invalid frame, it was dropped
+   - \b  ARM_DRIVER_ERROR_BUSY: no spare buffer, the frame is left for ReadFrame
+*/
+extern int32_t EMAC_RxFrameLoan (uint8_t **frame);
+
+/**
+  \fn          int32_t EMAC_RxFrameReturn (uint8_t *frame)
+  \brief       Give a buffer taken with \ref EMAC_RxFrameLoan back to the driver.
+               Can be called from any task or interrupt.
+  \param[in]   frame  Frame buffer address
+  \returns     \ref execution_status, ARM_DRIVER_ERROR_PARAMETER when the buffer
+               is not on loan
+*/
+extern int32_t EMAC_RxFrameReturn (uint8_t *frame);
+
+/**
+  \fn          int32_t EMAC_TxFrameLoan (const uint8_t *frame, uint32_t len, uint32_t flags)
+  \brief       Queue a frame fragment straight from the caller's buffer, one Tx
+               descriptor per fragment. The buffer must be in AHB SRAM
+               (RamAHB32) and stay untouched until \ref EMAC_TxRelease_t
+               gives it back. Fragments can be mixed with SendFrame ones, a
+               frame may use up to NUM_TX_BUF-1 descriptors. With transmit
+               checksum offload the checksum fields are written in the
+               buffers, the IPv4 header and the ICMP/UDP/TCP header up to its
+               checksum field must then be in the first fragment.
+  \param[in]   frame  Pointer to frame buffer with data to send
+  \param[in]   len    Frame buffer length in bytes
+  \param[in]   flags  Frame transmit flags (see ARM_ETH_MAC_TX_FRAME_...)
+  \returns
+   - \b  ARM_DRIVER_OK: fragment queued
+   - \b  ARM_DRIVER_ERROR_BUSY: no free Tx descriptor, retry after a Tx event
+   - \b  ARM_DRIVER_ERROR_PARAMETER: buffer not in AHB SRAM
+*/
+extern int32_t EMAC_TxFrameLoan (const uint8_t *frame, uint32_t len, uint32_t flags);
+
+/**
+  \fn          int32_t EMAC_SetTxRelease (EMAC_TxRelease_t cb_release)
+  \brief       Set callback for buffers loaned with \ref EMAC_TxFrameLoan.
+               Must be set after Initialize.
+  \param[in]   cb_release  Pointer to \ref EMAC_TxRelease_t
+  \returns     \ref execution_status
+*/
+extern int32_t EMAC_SetTxRelease (EMAC_TxRelease_t cb_release);
+
+/**
+  \fn          int32_t EMAC_SetRxPoll (uint32_t enable)
+  \brief       Set receive interrupt mode. In polled mode the receive interrupt
+               masks itself after signaling ARM_ETH_MAC_EVENT_RX_FRAME, frames
+               are read without interrupts until \ref EMAC_RxIrqEnable.
+               Must be set after Initialize.
+  \param[in]   enable  0=interrupt per frame (default), 1=polled
+  \returns     \ref execution_status
+*/
+extern int32_t EMAC_SetRxPoll (uint32_t enable);
+
+/**
+  \fn          int32_t EMAC_RxIrqEnable (void)
+  \brief       Unmask the receive interrupt once the Rx ring is drained.
+  \returns
+   - \b  1: frames arrived meanwhile, keep reading
+   - \b  0: Rx ring empty, the next frame signals an event
+   - \ref execution_status on error
+*/
+extern int32_t EMAC_RxIrqEnable (void);
+
+/**
+  \fn          int32_t EMAC_JoinGroup (const ARM_ETH_MAC_ADDR *ptr_addr)
+  \brief       Join a multicast group. Joins are counted, each needs a
+               \ref EMAC_LeaveGroup. The hash filter bin of the group is
+               shared with other groups, received frames are checked against
+               the joined groups and the others dropped.
+  \param[in]   ptr_addr  Pointer to group MAC address
+  \returns     \ref execution_status, ARM_DRIVER_ERROR_BUSY when the group table is full
+*/
+extern int32_t EMAC_JoinGroup (const ARM_ETH_MAC_ADDR *ptr_addr);
+
+/**
+  \fn          int32_t EMAC_LeaveGroup (const ARM_ETH_MAC_ADDR *ptr_addr)
+  \brief       Leave a multicast group joined with \ref EMAC_JoinGroup.
+  \param[in]   ptr_addr  Pointer to group MAC address
+  \returns     \ref execution_status
+*/
+extern int32_t EMAC_LeaveGroup (const ARM_ETH_MAC_ADDR *ptr_addr);
+
+/**
+  \fn          int32_t EMAC_GetStats (EMAC_STATS *stats)
+  \brief       Get statistics counters. Each counter is a word with a single
+               writer, so no lock is taken. Counters are not a consistent
+               snapshot of each other.
+  \param[out]  stats  Pointer where the counters are copied to
+  \returns     \ref execution_status
+*/
+extern int32_t EMAC_GetStats (EMAC_STATS *stats);
+
+/**
+  \fn          int32_t EMAC_PHY_ReadStart (uint8_t phy_addr, uint8_t reg_addr)
+  \brief       Start reading a PHY register and return without waiting for
+               the MII, \ref EMAC_PHY_Poll gets the result. One access at a
+               time, not to be mixed with the blocking PHY_Read/PHY_Write.
+               LPC175x devices clock the frame in software before returning.
+  \param[in]   phy_addr  5-bit device address
+  \param[in]   reg_addr  5-bit register address
+  \returns     \ref execution_status, ARM_DRIVER_ERROR_BUSY while an access runs
+*/
+extern int32_t EMAC_PHY_ReadStart (uint8_t phy_addr, uint8_t reg_addr);
+
+/**
+  \fn          int32_t EMAC_PHY_WriteStart (uint8_t phy_addr, uint8_t reg_addr, uint16_t data)
+  \brief       Start writing a PHY register, see \ref EMAC_PHY_ReadStart.
+  \param[in]   phy_addr  5-bit device address
+  \param[in]   reg_addr  5-bit register address
+  \param[in]   data      16-bit data to write
+  \returns     \ref execution_status, ARM_DRIVER_ERROR_BUSY while an access runs
+*/
+extern int32_t EMAC_PHY_WriteStart (uint8_t phy_addr, uint8_t reg_addr, uint16_t data);
+
+/**
+  \fn          int32_t EMAC_PHY_Poll (uint16_t *data)
+  \brief       Check whether the started PHY register access is done.
+  \param[out]  data  Pointer where the read result is written to
+  \returns
+   - \ref ARM_DRIVER_OK: done, data holds the register for a read
+   - \b  ARM_DRIVER_ERROR_BUSY: MII still running
+   - \ref execution_status on error
+*/
+extern int32_t EMAC_PHY_Poll (uint16_t *data);
+
 #endif        // EMAC_LPC17XX_H
@@ -17,8 +17,8 @@
  * limitations under the License.
  *
  *
- * $Date:        10. Januar 2020
- * $Revision:    V1.4
+ * $Date:        17. October 2026
+ * $Revision:    V1.10
  *
  * Project:      GPDMA Driver Definitions for NXP LPC17xx
  * -------------------------------------------------------------------------- */
@@ -35,9 +35,45 @@
 // Number of GPDMA channels
 #define GPDMA_NUMBER_OF_CHANNELS           ((uint8_t) 8)
 
+// Maximum number of data items in one transfer (link list item)
+#define GPDMA_LLI_MAX_SIZE                 (0xFFFU)
+
+// Number of link list items needed for a transfer of n data items
+#define GPDMA_LLI_NUM(n)                   ((n) ? (((n) + GPDMA_LLI_MAX_SIZE - 1U) / GPDMA_LLI_MAX_SIZE) : 1U)
+
+// Number of driver owned link list items per channel, used by
+// GPDMA_ChannelConfigure to run transfers bigger than 4k without re-arming
+#ifndef GPDMA_CHANNEL_LLI_NUM
+#define GPDMA_CHANNEL_LLI_NUM              (4U)
+#endif
+
+// GPDMA channel priority classes, channel 0 has the highest priority
+#define GPDMA_PRIO_HIGH                    (0U) // Channels 0..1
+#define GPDMA_PRIO_MEDIUM                  (1U) // Channels 2..4
+#define GPDMA_PRIO_LOW                     (2U) // Channels 5..7
+
+// Channel number taken from the channel pool per transfer, instead of a
+// fixed channel number
+#define GPDMA_CHANNEL_POOL(prio)           ((uint8_t)(0x80U | (prio)))
+#define GPDMA_CHANNEL_IS_POOL(ch)          (((ch) & 0x80U) != 0U)
+#define GPDMA_CHANNEL_PRIO(ch)             ((uint8_t)((ch) & 0x7FU))
+
+// Channels handed out by the channel pool. Channels RTE_Device.h assigns to
+// a driver with a fixed number are always left out on top of this mask.
+#ifndef GPDMA_CHANNEL_POOL_MASK
+#define GPDMA_CHANNEL_POOL_MASK            (0xFFU)
+#endif
+
+// Record interrupt entry to callback latency per channel, in DWT cycles.
+// The DWT cycle counter has to be enabled by the application.
+#ifndef GPDMA_IRQ_LATENCY
+#define GPDMA_IRQ_LATENCY                  (0U)
+#endif
+
 // GPDMA Events
 #define GPDMA_EVENT_TERMINAL_COUNT_REQUEST (1U)
 #define GPDMA_EVENT_ERROR                  (2U)
+#define GPDMA_EVENT_HALF_TRANSFER          (4U)
 
 // GPDMA Burst size in Source and Destination definitions
 #define GPDMA_BSIZE_1                      (0U) // Burst size = 1
@@ -174,6 +210,18 @@
 */
 typedef void (*GPDMA_SignalEvent_t) (uint32_t event);
 
+/**
+  \brief       GPDMA link list item, layout matches the channel registers.
+               Items are fetched by the GPDMA, so they must be word aligned
+               and placed in AHB SRAM (RamAHB32), not in the local SRAM.
+*/
+typedef struct {
+  uint32_t SrcAddr;             // Source address
+  uint32_t DestAddr;            // Destination address
+  uint32_t Next;                // Address of next item, 0 for the last one
+  uint32_t Control;             // Channel control
+} GPDMA_LLI;
+
 /**
   \fn          int32_t GPDMA_Initialize (void)
   \brief       Initialize GPDMA peripheral
@@ -203,6 +251,27 @@ extern int32_t GPDMA_Uninitialize (void);
 */
 extern int32_t GPDMA_PeripheralSelect (uint8_t peri, uint8_t sel);
 
+/**
+  \fn          int32_t GPDMA_ChannelAllocate (uint8_t prio)
+  \brief       Take a free channel from the channel pool
+  \param[in]   prio      Priority class (GPDMA_PRIO_HIGH..GPDMA_PRIO_LOW),
+                         a lower class is used when the class is exhausted
+  \returns
+   - \b  0..7: allocated channel number
+   - \b    -1: no channel free
+*/
+extern int32_t GPDMA_ChannelAllocate (uint8_t prio);
+
+/**
+  \fn          int32_t GPDMA_ChannelRelease (uint8_t ch)
+  \brief       Return channel to the channel pool
+  \param[in]   ch Channel number (0..7)
+  \returns
+   - \b  0: function succeeded
+   - \b -1: function failed, channel not allocated or still active
+*/
+extern int32_t GPDMA_ChannelRelease (uint8_t ch);
+
 /**
   \fn          int32_t GPDMA_ChannelConfigure (uint8_t              ch,
                                                uint32_t             src_addr,
@@ -231,6 +300,92 @@ extern int32_t GPDMA_ChannelConfigure (uint8_t              ch,
                                        uint32_t             config,
                                        GPDMA_SignalEvent_t  cb_event);
 
+/**
+  \fn          int32_t GPDMA_ChainBuild (GPDMA_LLI *lli,
+                                         uint32_t   num,
+                                         uint32_t   src_addr,
+                                         uint32_t   dest_addr,
+                                         uint32_t   size,
+                                         uint32_t   control)
+  \brief       Build link list for one buffer, split into 4k items
+  \param[out]  lli       Link list items
+  \param[in]   num       Number of items available in lli
+  \param[in]   src_addr  Source address
+  \param[in]   dest_addr Destination address
+  \param[in]   size      Amount of data to transfer
+  \param[in]   control   Channel control, terminal count interrupt
+                         (GPDMA_CH_CONTROL_I) is kept on the last item only
+  \returns
+   - \b  >0: number of items used
+   - \b  -1: function failed
+*/
+extern int32_t GPDMA_ChainBuild (GPDMA_LLI *lli,
+                                 uint32_t   num,
+                                 uint32_t   src_addr,
+                                 uint32_t   dest_addr,
+                                 uint32_t   size,
+                                 uint32_t   control);
+
+/**
+  \fn          void GPDMA_ChainLink (GPDMA_LLI *tail, const GPDMA_LLI *next)
+  \brief       Link two lists into one transfer
+  \param[in]   tail      Last item of the first list
+  \param[in]   next      First item of the second list
+*/
+extern void GPDMA_ChainLink (GPDMA_LLI *tail, const GPDMA_LLI *next);
+
+/**
+  \fn          int32_t GPDMA_ChannelConfigureChain (uint8_t              ch,
+                                                    const GPDMA_LLI     *lli,
+                                                    uint32_t             config,
+                                                    GPDMA_SignalEvent_t  cb_event)
+  \brief       Configure GPDMA channel for link list transfer
+  \param[in]   ch        Channel number (0..7)
+  \param[in]   lli       First item of a terminated link list
+  \param[in]   config    Channel configuration
+  \param[in]   cb_event  Channel callback pointer
+  \returns
+   - \b  0: function succeeded
+   - \b -1: function failed, also for a list linked back onto itself
+*/
+extern int32_t GPDMA_ChannelConfigureChain (uint8_t              ch,
+                                            const GPDMA_LLI     *lli,
+                                            uint32_t             config,
+                                            GPDMA_SignalEvent_t  cb_event);
+
+/**
+  \fn          int32_t GPDMA_ChannelConfigureCircular (uint8_t              ch,
+                                                       uint32_t             src_addr,
+                                                       uint32_t             dest_addr,
+                                                       uint32_t             size,
+                                                       uint32_t             control,
+                                                       uint32_t             config,
+                                                       GPDMA_SignalEvent_t  cb_event)
+  \brief       Configure GPDMA channel for continuous circular transfer.
+               GPDMA_EVENT_HALF_TRANSFER is signaled when the first half of
+               the buffer is done, GPDMA_EVENT_TERMINAL_COUNT_REQUEST when
+               the second half is done, and the transfer starts over until
+               the channel is disabled.
+  \param[in]   ch        Channel number (0..7)
+  \param[in]   src_addr  Source address
+  \param[in]   dest_addr Destination address
+  \param[in]   size      Amount of data in the buffer, even and at most
+                         GPDMA_CHANNEL_LLI_NUM * 4k
+  \param[in]   control   Channel control
+  \param[in]   config    Channel configuration
+  \param[in]   cb_event  Channel callback pointer
+  \returns
+   - \b  0: function succeeded
+   - \b -1: function failed
+*/
+extern int32_t GPDMA_ChannelConfigureCircular (uint8_t              ch,
+                                               uint32_t             src_addr,
+                                               uint32_t             dest_addr,
+                                               uint32_t             size,
+                                               uint32_t             control,
+                                               uint32_t             config,
+                                               GPDMA_SignalEvent_t  cb_event);
+
 /**
   \fn          int32_t GPDMA_ChannelEnable (uint8_t ch)
   \brief       Enable GPDMA channel
@@ -263,10 +418,20 @@ extern uint32_t GPDMA_ChannelGetStatus (uint8_t ch);
 
 /**
   \fn          uint32_t GPDMA_ChannelGetCount (uint8_t ch)
-  \brief       Get number of transferred data
+  \brief       Get number of transferred data, for circular transfers
+               the position in the buffer
   \param[in]   ch Channel number (0..7)
   \returns     Number of transferred data
 */
 extern uint32_t GPDMA_ChannelGetCount (uint8_t ch);
 
+/**
+  \fn          uint32_t GPDMA_ChannelGetLatency (uint8_t ch, uint32_t *max)
+  \brief       Get interrupt entry to callback latency (GPDMA_IRQ_LATENCY)
+  \param[in]   ch  Channel number (0..7)
+  \param[out]  max Highest latency seen
+  \returns     Latency of the last callback in DWT cycles, 0 when not recorded
+*/
+extern uint32_t GPDMA_ChannelGetLatency (uint8_t ch, uint32_t *max);
+
 #endif /* __GPDMA_LPC17XX_H */
@@ -0,0 +1,106 @@
+/* --------------------------------------------------------------------------
+ * $Date:        17. October 2026
+ * $Revision:    V1.1
+ *
+ * Project:      Internet Checksum (RFC 1071) Definitions
+ * -------------------------------------------------------------------------- */
+
+#ifndef __IP_CSUM_H
+#define __IP_CSUM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "cmsis_compiler.h"
+
+/*
+  Partial sums are 32-bit one's complement sums of the data as read from
+  memory, so the folded result is stored back as is, without byte swapping.
+  A block must start at an even offset of the checksummed range, blocks
+  starting at an odd offset are corrected with IP_CSUM_Swap.
+*/
+
+/**
+  \fn          uint32_t IP_CSUM_Add (uint32_t sum, const void *data, uint32_t len)
+  \brief       Add data to a partial Internet checksum.
+  \param[in]   sum   Partial sum of the preceding data, 0 for the first block
+  \param[in]   data  Pointer to buffer containing the data, any alignment
+  \param[in]   len   Data length in bytes
+  \returns     partial sum
+*/
+extern uint32_t IP_CSUM_Add (uint32_t sum, const void *data, uint32_t len);
+
+/**
+  \fn          uint32_t IP_CSUM_Copy (uint32_t sum, void *dst, const void *src, uint32_t len)
+  \brief       Copy data and add it to a partial Internet checksum in the same pass.
+  \param[in]   sum   Partial sum of the preceding data, 0 for the first block
+  \param[out]  dst   Pointer to destination buffer, any alignment
+  \param[in]   src   Pointer to source buffer, any alignment
+  \param[in]   len   Data length in bytes
+  \returns     partial sum
+*/
+extern uint32_t IP_CSUM_Copy (uint32_t sum, void *dst, const void *src, uint32_t len);
+
+/**
+  \fn          void IP_CSUM_FrameInsert (uint8_t *frame, uint32_t len, uint32_t sum)
+  \brief       Fill in IPv4 and ICMP/UDP/TCP checksums of an Ethernet frame to send.
+               Other frames and IP fragments are left as they are.
+  \param[in]   frame  Frame data
+  \param[in]   len    Frame length in bytes
+  \param[in]   sum    Partial sum of the whole frame with the checksum fields as they are
+*/
+extern void IP_CSUM_FrameInsert (uint8_t *frame, uint32_t len, uint32_t sum);
+
+/**
+  \fn          bool IP_CSUM_FrameCheck (const uint8_t *frame, uint32_t len, uint32_t sum)
+  \brief       Verify IPv4 and ICMP/UDP/TCP checksums of a received Ethernet frame.
+  \param[in]   frame  Frame data
+  \param[in]   len    Frame length in bytes
+  \param[in]   sum    Partial sum of the whole frame
+  \returns     false when a checksum is wrong, true otherwise
+*/
+extern bool IP_CSUM_FrameCheck (const uint8_t *frame, uint32_t len, uint32_t sum);
+
+/**
+  \fn          uint32_t IP_CSUM_FrameEnd (const uint8_t *frame, uint32_t size, uint32_t len)
+  \brief       Get the IPv4 datagram end of a frame of which only the first size
+               bytes are contiguous. The checksums are then filled in with
+               IP_CSUM_FrameInsert (frame, end, sum), sum taken over the first
+               end bytes of the frame, which only touches the headers at frame.
+  \param[in]   frame  Frame data
+  \param[in]   size   Bytes at frame
+  \param[in]   len    Frame length in bytes
+  \returns     offset of the IPv4 datagram end, 0 for other frames or when the
+               headers up to the checksum field are not within size
+*/
+extern uint32_t IP_CSUM_FrameEnd (const uint8_t *frame, uint32_t size, uint32_t len);
+
+/**
+  \fn          uint32_t IP_CSUM_Merge (uint32_t sum, uint32_t val)
+  \brief       Add two partial sums, IP_CSUM_Merge (sum, ~val) subtracts val.
+*/
+__STATIC_INLINE uint32_t IP_CSUM_Merge (uint32_t sum, uint32_t val) {
+  sum += val;
+  return (sum + (sum < val));
+}
+
+/**
+  \fn          uint32_t IP_CSUM_Fold (uint32_t sum)
+  \brief       Fold a partial sum to 16 bits, the checksum field is the complement.
+*/
+__STATIC_INLINE uint32_t IP_CSUM_Fold (uint32_t sum) {
+  sum = (sum & 0xFFFFU) + (sum >> 16);
+  sum = (sum & 0xFFFFU) + (sum >> 16);
+  return (sum);
+}
+
+/**
+  \fn          uint32_t IP_CSUM_Swap (uint32_t sum)
+  \brief       Correct the partial sum of a block starting at an odd offset.
+*/
+__STATIC_INLINE uint32_t IP_CSUM_Swap (uint32_t sum) {
+  sum = IP_CSUM_Fold (sum);
+  return (((sum << 8) | (sum >> 8)) & 0xFFFFU);
+}
+
+#endif // __IP_CSUM_H
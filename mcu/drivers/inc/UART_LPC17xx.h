@@ -18,7 +18,7 @@
  *
  *
  * $Date:        10. Januar 2020
- * $Revision:    V2.6
+ * $Revision:    V2.8
  *
  * Project:      UART Driver Definitions for NXP LPC17xx
  * -------------------------------------------------------------------------- */
@@ -45,6 +45,13 @@
 #include "RTE_Device.h"
 #include "RTE_Components.h"
 
+// Count the cycles spent in the UART interrupt and its GPDMA events, the
+// callbacks they make included. The DWT cycle counter has to be enabled by
+// the application.
+#ifndef USART_IRQ_CYCLES
+#define USART_IRQ_CYCLES             (0U)
+#endif
+
 // USART register interface definitions
 // USART Divisor Latch register LSB
 #define USART_DLL_DLLSB_POS          (     0U)
@@ -199,6 +206,14 @@
 #define FIXED_OVERSAMPLING_DIVIDER_LIMIT   (51U  << FRACT_BITS)
 #define INTEGER_OVERSAMPLING_DIVIDER_LIMIT ((12U << FRACT_BITS) + (8 << FRACT_BITS) / 10)
 
+// Smallest divider for the fractional divider search. Without an oversampling
+// register it reaches down to 16 * latch divider of 3.
+#if defined (LPC175x_6x)
+#define FRACT_DIVIDER_LIMIT                (48U  << FRACT_BITS)
+#else
+#define FRACT_DIVIDER_LIMIT                FIXED_OVERSAMPLING_DIVIDER_LIMIT
+#endif
+
 // Baudrate accepted error
 #define USART_MAX_BAUDRATE_ERROR     ( 3U )
 #define USART_MAX_DIVIDER_ERROR      ( 3U )
@@ -250,12 +265,14 @@ typedef struct {
   uint32_t                baudrate;      // Baudrate
   uint8_t                 mode;          // USART mode
   uint8_t                 flags;         // USART driver flags
-  uint8_t                 reserved[2];
+  uint8_t                 tx_dma_ch;     // DMA TX Channel number in use
+  uint8_t                 rx_dma_ch;     // DMA RX Channel number in use
+  uint32_t                irq_cycles;    // Cycles in interrupts (USART_IRQ_CYCLES)
 } USART_INFO;
 
 // USART DMA
 typedef const struct {
-  uint8_t                 channel;       // DMA Channel number
+  uint8_t                 channel;       // DMA Channel number or GPDMA_CHANNEL_POOL(prio)
   uint8_t                 request;       // DMA Request number
   uint8_t                 select;        // DMA Request select number
   uint8_t                 reserved;
@@ -334,4 +351,13 @@ extern ARM_DRIVER_USART Driver_USART3;
 extern ARM_DRIVER_USART Driver_USART4;
 #endif
 
+/**
+  \fn          uint32_t USART_GetIrqCycles (uint8_t uart)
+  \brief       Get cycles spent in the UART interrupt and its GPDMA events
+               (USART_IRQ_CYCLES)
+  \param[in]   uart  UART number (0..4)
+  \returns     Running total of DWT cycles, 0 when not recorded
+*/
+extern uint32_t USART_GetIrqCycles (uint8_t uart);
+
 #endif /* __USART_LPC17XX_H */
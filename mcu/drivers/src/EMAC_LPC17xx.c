@@ -17,8 +17,8 @@
  * limitations under the License.
  *
  *
- * $Date:        22. November 2023
- * $Revision:    V2.14
+ * $Date:        17. October 2026
+ * $Revision:    V2.30
  *
  * Driver:       Driver_ETH_MAC0
  * Configured:   via RTE_Device.h configuration file
@@ -33,6 +33,43 @@
  * -------------------------------------------------------------------------- */
 
 /* History:
+ *  Version 2.30
+ *    EMAC_TxFrameLoan rejects buffers outside AHB SRAM
+ *  Version 2.29
+ *    EMAC_RxFrameReturn only takes buffers that are on loan
+ *  Version 2.28
+ *    Rx ring exhaustion counted from the RxFinished and RxOverrun interrupts
+ *  Version 2.27
+ *    SetAddressFilter hashes unicast entries again (RFC_UCAST_HASH_EN)
+ *    SetAddressFilter checks all entries before replacing the filter
+ *  Version 2.26
+ *    Transmit checksum offload covers frames with loaned fragments
+ *  Version 2.25
+ *    Frame checksum helpers moved to the IP_CSUM module
+ *  Version 2.24
+ *    Added statistics counters (EMAC_GetStats), replaces EMAC_GetFilterStats
+ *  Version 2.23
+ *    Added non-blocking PHY register access (EMAC_PHY_ReadStart/WriteStart/Poll)
+ *  Version 2.22
+ *    Added multicast group join/leave with reference counted hash bins
+ *    Multicast frames passed by the hash filter are checked against the groups
+ *    SetAddressFilter no longer enables the unicast hash filter
+ *  Version 2.21
+ *    Added polled receive mode (EMAC_SetRxPoll/EMAC_RxIrqEnable)
+ *  Version 2.20
+ *    PHY register access timeout without CMSIS-RTOS
+ *  Version 2.19
+ *    Added software IPv4/ICMP/UDP/TCP checksum offload, done in the frame copy
+ *  Version 2.18
+ *    DMA descriptors and buffers placed in AHB SRAM (RamAHB32)
+ *    Buffer counts and size can be set from the build
+ *  Version 2.17
+ *    Added zero-copy scatter-gather transmit (EMAC_TxFrameLoan)
+ *    SendFrame returns ARM_DRIVER_ERROR_BUSY when all Tx descriptors are used
+ *  Version 2.16
+ *    Added zero-copy receive (EMAC_RxFrameLoan/EMAC_RxFrameReturn)
+ *  Version 2.15
+ *    Hash filter CRC uses the table driven CRC32 module
  *  Version 2.14
  *    Replaced empty delay loops with _NOP
  *  Version 2.13
@@ -72,10 +109,12 @@
  */
 
 #include "EMAC_LPC17xx.h"
+#include "CRC32.h"
+#include "IP_CSUM.h"
 
 extern ARM_DRIVER_ETH_MAC Driver_ETH_MAC0;
 
-#define ARM_ETH_MAC_DRV_VERSION ARM_DRIVER_VERSION_MAJOR_MINOR(2,14) /* driver version */
+#define ARM_ETH_MAC_DRV_VERSION ARM_DRIVER_VERSION_MAJOR_MINOR(2,30) /* driver version */
 
 /* Interrupt Handler Prototype */
 void ENET_IRQHandler (void);
@@ -83,10 +122,48 @@ void ENET_IRQHandler (void);
 /* Timeouts */
 #define PHY_TIMEOUT         500U        /* PHY Register access timeout in us  */
 
-/* EMAC Memory Buffer configuration for 16K Ethernet RAM */
+/* EMAC Memory Buffer configuration for 32K AHB SRAM (RamAHB32) */
+#ifndef NUM_RX_BUF
 #define NUM_RX_BUF          4U          /* 0x1800 for Rx (4*1536=6.0K)        */
+#endif
+#ifndef NUM_TX_BUF
 #define NUM_TX_BUF          3U          /* 0x1200 for Tx (3*1536=4.6K)        */
+#endif
+#ifndef ETH_BUF_SIZE
 #define ETH_BUF_SIZE        1536U       /* ETH Receive/Transmit buffer size   */
+#endif
+#ifndef NUM_RX_LOAN
+#define NUM_RX_LOAN         2U          /* Spare Rx buffers for loaned frames */
+#endif
+
+#ifndef NUM_MCAST_ADDR
+#define NUM_MCAST_ADDR      16U         /* Multicast groups joined at a time  */
+#endif
+
+#if (NUM_MCAST_ADDR > 255U)
+#error "Too many multicast groups for the hash bin reference counts!"
+#endif
+
+#if ((NUM_RX_BUF + NUM_RX_LOAN) > 32U)
+#error "Too many Rx buffers for the Rx buffer pool!"
+#endif
+
+#if ((NUM_RX_BUF < 2U) || (NUM_TX_BUF < 2U))
+#error "At least 2 Rx and 2 Tx descriptors are required!"
+#endif
+
+#if ((ETH_BUF_SIZE & 3U) || (ETH_BUF_SIZE > (RCTRL_SIZE + 1U)))
+#error "ETH_BUF_SIZE must be a multiple of 4 and at most 2048!"
+#endif
+
+/* EMAC DMA memory, kept in AHB SRAM off the bank with the CPU stack and heap.
+   Buffers are not cleared at startup, descriptors must be. */
+#define EMAC_DESC_RAM       __attribute__((section(".bss.$RAM2")))
+#define EMAC_BUF_RAM        __attribute__((section(".noinit.$RAM2")))
+
+/* AHB SRAM bounds from the linker script, the only RAM the EMAC DMA reaches */
+extern uint8_t __base_RAM2[];
+extern uint8_t __top_RAM2[];
 
 /* Ethernet Pin definitions */
 static PIN eth_pins[] = {
@@ -166,18 +243,18 @@ static const ARM_DRIVER_VERSION DriverVersion = {
   ARM_ETH_MAC_DRV_VERSION
 };
 
-/* Driver Capabilities */
+/* Driver Capabilities, checksums are done in software while copying frames */
 static const ARM_ETH_MAC_CAPABILITIES DriverCapabilities = {
-  0U,                               /* checksum_offload_rx_ip4  */
+  1U,                               /* checksum_offload_rx_ip4  */
   0U,                               /* checksum_offload_rx_ip6  */
-  0U,                               /* checksum_offload_rx_udp  */
-  0U,                               /* checksum_offload_rx_tcp  */
-  0U,                               /* checksum_offload_rx_icmp */
-  0U,                               /* checksum_offload_tx_ip4  */
+  1U,                               /* checksum_offload_rx_udp  */
+  1U,                               /* checksum_offload_rx_tcp  */
+  1U,                               /* checksum_offload_rx_icmp */
+  1U,                               /* checksum_offload_tx_ip4  */
   0U,                               /* checksum_offload_tx_ip6  */
-  0U,                               /* checksum_offload_tx_udp  */
-  0U,                               /* checksum_offload_tx_tcp  */
-  0U,                               /* checksum_offload_tx_icmp */
+  1U,                               /* checksum_offload_tx_udp  */
+  1U,                               /* checksum_offload_tx_tcp  */
+  1U,                               /* checksum_offload_tx_icmp */
   ARM_ETH_INTERFACE_RMII,           /* media_interface          */
   0U,                               /* mac_address              */
   1U,                               /* event_rx_frame           */
@@ -188,27 +265,56 @@ static const ARM_ETH_MAC_CAPABILITIES DriverCapabilities = {
 };
 
 /* EMAC local DMA Descriptors. */
-static            RX_Desc Rx_Desc[NUM_RX_BUF];
-static __ALIGNED(8) RX_Stat Rx_Stat[NUM_RX_BUF]; /* Must be 8-Byte aligned   */
-static            TX_Desc Tx_Desc[NUM_TX_BUF];
-static            TX_Stat Tx_Stat[NUM_TX_BUF];
+static            RX_Desc Rx_Desc[NUM_RX_BUF] EMAC_DESC_RAM;
+static __ALIGNED(8) RX_Stat Rx_Stat[NUM_RX_BUF] EMAC_DESC_RAM; /* Must be 8-Byte aligned */
+static            TX_Desc Tx_Desc[NUM_TX_BUF] EMAC_DESC_RAM;
+static            TX_Stat Tx_Stat[NUM_TX_BUF] EMAC_DESC_RAM;
 
 /* EMAC local DMA buffers. */
-static uint32_t rx_buf[NUM_RX_BUF][ETH_BUF_SIZE>>2];
-static uint32_t tx_buf[NUM_TX_BUF][ETH_BUF_SIZE>>2];
+static uint32_t rx_buf[NUM_RX_BUF+NUM_RX_LOAN][ETH_BUF_SIZE>>2] EMAC_BUF_RAM;
+static uint32_t tx_buf[NUM_TX_BUF][ETH_BUF_SIZE>>2] EMAC_BUF_RAM;
 
 /* Local variables */
 static EMAC_CTRL  emac_control = { 0 };
 #define emac     (emac_control)
 
+/* Tx descriptors pointing at a buffer loaned by the caller */
+static uint8_t Tx_loan[NUM_TX_BUF];
+
+/* Rx buffers neither in a descriptor nor on loan, the spares to start with */
+static uint32_t Rx_free = ((1U << NUM_RX_LOAN) - 1U) << NUM_RX_BUF;
+
+/* Rx buffers handed out by EMAC_RxFrameLoan and not yet returned */
+static uint32_t Rx_loan;
+
+/* Statistics, each counter has a single writer: the ISR, the sender or the
+   receiver. Counters are read without locks. */
+static EMAC_STATS emac_stats;
+
+/* Joined multicast groups and the groups using each hash filter bin, a bin
+   opened by unicast entries of SetAddressFilter counts as one more user */
+static ARM_ETH_MAC_ADDR Mcast_addr[NUM_MCAST_ADDR];
+static uint8_t Mcast_ref[NUM_MCAST_ADDR];
+static uint8_t Mcast_num;
+static uint8_t Hash_ref[64];
+static uint32_t Ucast_bins[2];
+
 typedef void (*IAP)(uint32_t *cmd, uint32_t *res);
 static IAP iap_entry = (IAP)0x1FFF1FF1;
 
 /* Local functions */
 static void init_rx_desc (void);
 static void init_tx_desc (void);
-static uint32_t crc32_8bit_rev (uint32_t crc32, uint8_t val);
-static uint32_t crc32_data (const uint8_t *data, uint32_t len);
+static uint32_t tx_next_desc (void);
+static bool tx_desc_free (uint32_t idx);
+static void tx_csum_chain (uint32_t last);
+static void tx_start_frame (uint32_t idx);
+static uint32_t hash_index (const uint8_t *addr);
+static void hash_set (uint32_t bin, bool set);
+static int32_t mcast_find (const uint8_t *addr);
+static void mcast_clear (void);
+static bool mcast_reject (uint32_t info, const uint8_t *frame);
+static void rx_count (uint32_t idx, bool valid);
 
 /**
   \fn          void output_MDIO (uint32_t val, uint32_t n)
@@ -264,7 +370,10 @@ static void init_rx_desc (void) {
   uint32_t i;
 
   for (i = 0U; i < NUM_RX_BUF; i++) {
-    Rx_Desc[i].Packet  = (uint8_t *)&rx_buf[i];
+    /* Keep buffers swapped in by EMAC_RxFrameLoan, the originals may be on loan */
+    if (Rx_Desc[i].Packet == NULL) {
+      Rx_Desc[i].Packet = (uint8_t *)&rx_buf[i];
+    }
     Rx_Desc[i].Ctrl    = RCTRL_INT | (ETH_BUF_SIZE-1);
     Rx_Stat[i].Info    = 0U;
     Rx_Stat[i].HashCRC = 0U;
@@ -288,6 +397,11 @@ static void init_tx_desc (void) {
   uint32_t i;
 
   for (i = 0U; i < NUM_TX_BUF; i++) {
+    /* Give back loaned buffers of frames not sent */
+    if (Tx_loan[i] && emac.tx_release) {
+      emac.tx_release (Tx_Desc[i].Packet);
+    }
+    Tx_loan[i]        = 0U;
     Tx_Desc[i].Packet = (uint8_t *)&tx_buf[i];
     Tx_Desc[i].Ctrl   = 0U;
     Tx_Stat[i].Info   = 0U;
@@ -300,44 +414,212 @@ static void init_tx_desc (void) {
 
   /* Tx Descriptors Point to 0 */
   LPC_EMAC->TxProduceIndex  = 0U;
+  emac.tx_done  = 0U;
+  emac.tx_frags = 0U;
+}
+
+/**
+  \fn          uint32_t tx_next_desc (void)
+  \brief       Get the Tx descriptor for the next fragment of the frame.
+  \return      descriptor index.
+*/
+static uint32_t tx_next_desc (void) {
+  uint32_t idx;
+
+  idx = LPC_EMAC->TxProduceIndex + emac.tx_frags;
+  if (idx >= NUM_TX_BUF) idx -= NUM_TX_BUF;
+
+  return (idx);
 }
 
 /**
-  \fn          uint32_t crc32_8bit_rev (uint32_t crc32, uint8_t val)
-  \brief       Calculate 32-bit CRC (Polynom: 0x04C11DB7, data bit-reversed).
-  \param[in]   crc32  CRC initial value
-  \param[in]   val    Input value
-  \return      Calculated CRC value
+  \fn          bool tx_desc_free (uint32_t idx)
+  \brief       Check if a Tx descriptor can take a new fragment.
+  \param[in]   idx  Descriptor index from tx_next_desc
+  \return      true when the descriptor is free.
+*/
+static bool tx_desc_free (uint32_t idx) {
+  /* One descriptor is kept free to tell a full ring from an empty one */
+  if (++idx == NUM_TX_BUF) idx = 0U;
+  return (idx != emac.tx_done);
+}
+
+/**
+  \fn          void tx_csum_chain (uint32_t last)
+  \brief       Fill in checksums of a frame spread over Tx descriptors.
+  \param[in]   last  Descriptor index of the last frame fragment
+  \return      none.
 */
-static uint32_t crc32_8bit_rev (uint32_t crc32, uint8_t val) {
-  uint32_t n;
-
-  crc32 ^= __RBIT(val);
-  for (n = 8U; n; n--) {
-    if (crc32 & 0x80000000U) {
-      crc32 <<= 1;
-      crc32  ^= 0x04C11DB7U;
-    } else {
-      crc32 <<= 1;
+static void tx_csum_chain (uint32_t last) {
+  uint8_t *frame;
+  uint32_t idx, len, end, off, n, sum, part;
+
+  idx = LPC_EMAC->TxProduceIndex;
+  frame = Tx_Desc[idx].Packet;
+  for (len = 0U; ; ) {
+    len += (Tx_Desc[idx].Ctrl & TCTRL_SIZE) + 1U;
+    if (idx == last) break;
+    if (++idx == NUM_TX_BUF) idx = 0U;
+  }
+
+  /* Headers up to the checksum field must be in the first fragment */
+  idx = LPC_EMAC->TxProduceIndex;
+  end = IP_CSUM_FrameEnd (frame, (Tx_Desc[idx].Ctrl & TCTRL_SIZE) + 1U, len);
+  if (end == 0U) {
+    return;
+  }
+
+  /* Sum the datagram, fragments may start at an odd offset */
+  for (sum = 0U, off = 0U; off < end; off += n) {
+    n = (Tx_Desc[idx].Ctrl & TCTRL_SIZE) + 1U;
+    if (n > (end - off)) n = end - off;
+    part = IP_CSUM_Add (0U, Tx_Desc[idx].Packet, n);
+    sum  = IP_CSUM_Merge (sum, (off & 1U) ? IP_CSUM_Swap (part) : part);
+    if (++idx == NUM_TX_BUF) idx = 0U;
+  }
+
+  IP_CSUM_FrameInsert (frame, end, sum);
+}
+
+/**
+  \fn          void tx_start_frame (uint32_t idx)
+  \brief       Hand a frame to EMAC.
+  \param[in]   idx  Descriptor index of the last frame fragment
+  \return      none.
+*/
+static void tx_start_frame (uint32_t idx) {
+  uint32_t fill;
+
+  emac.tx_frags = 0U;
+
+  /* Start frame transmission. */
+  if (++idx == NUM_TX_BUF) idx = 0U;
+  LPC_EMAC->TxProduceIndex = idx;
+
+  /* Descriptors not yet reclaimed */
+  fill = idx + NUM_TX_BUF - emac.tx_done;
+  if (fill >= NUM_TX_BUF) fill -= NUM_TX_BUF;
+  if (fill > emac_stats.tx_ring_hwm) {
+    emac_stats.tx_ring_hwm = fill;
+  }
+}
+
+/**
+  \fn          uint32_t hash_index (const uint8_t *addr)
+  \brief       Get the hash filter bin of a MAC address.
+  \param[in]   addr  MAC address
+  \return      bin number 0..63
+*/
+static uint32_t hash_index (const uint8_t *addr) {
+  /* Hash index is CRC bits [28:23], MSB-first, the table CRC is reflected */
+  return ((__RBIT (~CRC32_Update (CRC32_INIT, addr, 6U)) >> 23) & 0x3FU);
+}
+
+/**
+  \fn          void hash_set (uint32_t bin, bool set)
+  \brief       Set or clear a hash filter bin.
+  \param[in]   bin  Bin number 0..63
+  \param[in]   set  true to pass frames hashing to the bin
+*/
+static void hash_set (uint32_t bin, bool set) {
+  volatile uint32_t *reg = (bin & 0x20U) ? &LPC_EMAC->HashFilterH : &LPC_EMAC->HashFilterL;
+
+  if (set) {
+    *reg |=  (1U << (bin & 0x1FU));
+  }
+  else {
+    *reg &= ~(1U << (bin & 0x1FU));
+  }
+}
+
+/**
+  \fn          int32_t mcast_find (const uint8_t *addr)
+  \brief       Find a joined multicast group.
+  \param[in]   addr  Group MAC address
+  \return      group table index, -1 when not joined
+*/
+static int32_t mcast_find (const uint8_t *addr) {
+  uint32_t i;
+
+  for (i = 0U; i < NUM_MCAST_ADDR; i++) {
+    if (Mcast_ref[i] && (memcmp (&Mcast_addr[i].b[0], addr, 6U) == 0)) {
+      return ((int32_t)i);
     }
   }
-  return (crc32);
+  return (-1);
+}
+
+/**
+  \fn          void mcast_clear (void)
+  \brief       Leave all multicast groups, drop the unicast hash entries and
+               disable the hash filter.
+*/
+static void mcast_clear (void) {
+
+  memset (Mcast_ref,  0, sizeof (Mcast_ref));
+  memset (Hash_ref,   0, sizeof (Hash_ref));
+  memset (Ucast_bins, 0, sizeof (Ucast_bins));
+  Mcast_num = 0U;
+
+  LPC_EMAC->RxFilterCtrl &= ~(RFC_UCAST_HASH_EN | RFC_MCAST_HASH_EN);
+  LPC_EMAC->HashFilterH = 0x00000000U;
+  LPC_EMAC->HashFilterL = 0x00000000U;
 }
 
 /**
-  \fn          uint32_t crc32_data (const uint8_t *data, uint32_t len)
-  \brief       Calculate standard 32-bit Ethernet CRC.
-  \param[in]   data  Pointer to buffer containing the data
-  \param[in]   len   Data length in bytes
-  \return      Calculated CRC value
+  \fn          bool mcast_reject (uint32_t info, const uint8_t *frame)
+  \brief       Check a multicast frame passed by the hash filter against the
+               joined groups, the filter also passes other groups in the same bin.
+  \param[in]   info   Rx status information
+  \param[in]   frame  Frame data
+  \return      true when no joined group matches and the frame is to be dropped
 */
-static uint32_t crc32_data (const uint8_t *data, uint32_t len) {
-  uint32_t crc;
+static bool mcast_reject (uint32_t info, const uint8_t *frame) {
 
-  for (crc = 0xFFFFFFFFU; len; len--) {
-    crc = crc32_8bit_rev (crc, *data++);
+  if (!(info & RINFO_MCAST) || (info & RINFO_BCAST) || (Mcast_num == 0U) ||
+      (LPC_EMAC->RxFilterCtrl & RFC_MCAST_EN)) {
+    /* Not passed by the hash filter */
+    return (false);
+  }
+
+  emac_stats.hash_pass++;
+  if (mcast_find (frame) >= 0) {
+    return (false);
+  }
+  emac_stats.hash_drop++;
+  return (true);
+}
+
+/**
+  \fn          void rx_count (uint32_t idx, bool valid)
+  \brief       Count a received frame before its descriptor is released.
+  \param[in]   idx    Rx descriptor index
+  \param[in]   valid  false when software drops the frame
+*/
+static void rx_count (uint32_t idx, bool valid) {
+  uint32_t info = Rx_Stat[idx].Info;
+  uint32_t fill;
+
+  /* Frames waiting in the ring, this one included */
+  fill = LPC_EMAC->RxProduceIndex + NUM_RX_BUF - idx;
+  if (fill >= NUM_RX_BUF) fill -= NUM_RX_BUF;
+  if (fill > emac_stats.rx_ring_hwm) {
+    emac_stats.rx_ring_hwm = fill;
+  }
+
+  if (info & (RINFO_CRC_ERR | RINFO_SYM_ERR | RINFO_ALIGN_ERR)) {
+    emac_stats.rx_crc_err++;
+  }
+  else if (info & RINFO_OVERRUN) {
+    emac_stats.rx_overrun++;
+  }
+  else if (!(info & RINFO_LAST_FLAG) || (info & RINFO_ERR_MASK) || !valid) {
+    emac_stats.rx_dropped++;
+  }
+  else {
+    emac_stats.rx_frames++;
+    emac_stats.rx_bytes += (info & RINFO_SIZE) - 3U;
   }
-  return (crc);
 }
 
 /* Ethernet Driver functions */
@@ -643,10 +925,11 @@ static int32_t PowerControl (ARM_POWER_STATE state) {
   
       /* Receive Perfect Match Packets */
       LPC_EMAC->RxFilterCtrl = RFC_PERFECT_EN;
+      mcast_clear ();
 
       /* Enable EMAC interrupts */
       LPC_EMAC->IntClear  = 0xFFFFU;
-      LPC_EMAC->IntEnable = INT_RX_DONE | INT_TX_DONE;
+      LPC_EMAC->IntEnable = INT_RX_DONE | INT_TX_DONE | INT_RX_FIN | INT_RX_OVERRUN;
 
       /* Enable ethernet interrupts */
       NVIC_ClearPendingIRQ(ENET_IRQn);
@@ -721,16 +1004,17 @@ static int32_t SetMacAddress (const ARM_ETH_MAC_ADDR *ptr_addr) {
 /**
   \fn          int32_t SetAddressFilter (const ARM_ETH_MAC_ADDR *ptr_addr,
                                                uint32_t          num_addr)
-  \brief       Configure Address Filter.
+  \brief       Configure Address Filter. Multicast entries replace the joined
+               groups, unicast entries pass through the hash filter.
   \param[in]   ptr_addr  Pointer to addresses
   \param[in]   num_addr  Number of addresses to configure
   \return      \ref execution_status
 */
 static int32_t SetAddressFilter (const ARM_ETH_MAC_ADDR *ptr_addr, uint32_t num_addr) {
-  uint32_t crc;
+  uint32_t i, j, groups, bin;
 
-  if (!ptr_addr && num_addr) {
-    /* Invalid parameters */
+  if ((!ptr_addr && num_addr) || (num_addr > 0xFFU)) {
+    /* Invalid parameters, more entries than a join count holds */
     return ARM_DRIVER_ERROR_PARAMETER;
   }
 
@@ -739,27 +1023,132 @@ static int32_t SetAddressFilter (const ARM_ETH_MAC_ADDR *ptr_addr, uint32_t num_
     return ARM_DRIVER_ERROR;
   }
 
-  LPC_EMAC->RxFilterCtrl &= ~(RFC_UCAST_HASH_EN | RFC_MCAST_HASH_EN);
-  LPC_EMAC->HashFilterH = 0x00000000U;
-  LPC_EMAC->HashFilterL = 0x00000000U;
-  
-  if (num_addr == 0U) {
-    return ARM_DRIVER_OK;
+  /* Count the distinct groups first, the filter is left as it was when
+     they do not fit the group table */
+  for (i = 0U, groups = 0U; i < num_addr; i++) {
+    if (!(ptr_addr[i].b[0] & 0x01U)) continue;
+    for (j = 0U; j < i; j++) {
+      if (memcmp (&ptr_addr[j].b[0], &ptr_addr[i].b[0], 6U) == 0) break;
+    }
+    if (j == i) groups++;
   }
+  if (groups > NUM_MCAST_ADDR) {
+    return ARM_DRIVER_ERROR_BUSY;
+  }
+
+  /* Replace the joined groups and unicast entries */
+  mcast_clear ();
 
-  /* Calculate 64-bit Hash table for MAC addresses */
-  for ( ; num_addr; ptr_addr++, num_addr--) {
-    crc = crc32_data(&ptr_addr->b[0], 6U) >> 23;
-    if (crc & 0x20) {
-      LPC_EMAC->HashFilterH |= (1U << (crc & 0x1FU));
+  for (i = 0U; i < num_addr; i++) {
+    if (ptr_addr[i].b[0] & 0x01U) {
+      (void)EMAC_JoinGroup (&ptr_addr[i]);
+      continue;
     }
-    else {
-      LPC_EMAC->HashFilterL |= (1U << (crc & 0x1FU));
+
+    bin = hash_index (&ptr_addr[i].b[0]);
+    if (!(Ucast_bins[bin >> 5] & (1U << (bin & 0x1FU)))) {
+      Ucast_bins[bin >> 5] |= (1U << (bin & 0x1FU));
+      if (Hash_ref[bin]++ == 0U) {
+        hash_set (bin, true);
+      }
     }
+    LPC_EMAC->RxFilterCtrl |= RFC_UCAST_HASH_EN;
+  }
+
+  return ARM_DRIVER_OK;
+}
+
+/**
+  \fn          int32_t EMAC_JoinGroup (const ARM_ETH_MAC_ADDR *ptr_addr)
+  \brief       Join a multicast group.
+  \param[in]   ptr_addr  Pointer to group MAC address
+  \return      \ref execution_status
+*/
+int32_t EMAC_JoinGroup (const ARM_ETH_MAC_ADDR *ptr_addr) {
+  int32_t  idx;
+  uint32_t bin;
+
+  if (!ptr_addr || !(ptr_addr->b[0] & 0x01U)) {
+    /* Invalid parameters, not a multicast address */
+    return ARM_DRIVER_ERROR_PARAMETER;
+  }
+
+  if (!(emac.flags & EMAC_FLAG_POWER)) {
+    /* Driver not yet powered */
+    return ARM_DRIVER_ERROR;
+  }
+
+  idx = mcast_find (&ptr_addr->b[0]);
+  if (idx >= 0) {
+    /* Joined already */
+    if (Mcast_ref[idx] == 0xFFU) {
+      return ARM_DRIVER_ERROR;
+    }
+    Mcast_ref[idx]++;
+    return ARM_DRIVER_OK;
+  }
+
+  for (idx = 0; idx < (int32_t)NUM_MCAST_ADDR; idx++) {
+    if (Mcast_ref[idx] == 0U) break;
+  }
+  if (idx == (int32_t)NUM_MCAST_ADDR) {
+    /* Group table full */
+    return ARM_DRIVER_ERROR_BUSY;
+  }
+
+  Mcast_addr[idx] = *ptr_addr;
+  Mcast_ref[idx]  = 1U;
+  Mcast_num++;
+
+  /* Only the first group in a bin opens it */
+  bin = hash_index (&ptr_addr->b[0]);
+  if (Hash_ref[bin]++ == 0U) {
+    hash_set (bin, true);
+  }
+  LPC_EMAC->RxFilterCtrl |= RFC_MCAST_HASH_EN;
+
+  return ARM_DRIVER_OK;
+}
+
+/**
+  \fn          int32_t EMAC_LeaveGroup (const ARM_ETH_MAC_ADDR *ptr_addr)
+  \brief       Leave a multicast group joined with \ref EMAC_JoinGroup.
+  \param[in]   ptr_addr  Pointer to group MAC address
+  \return      \ref execution_status
+*/
+int32_t EMAC_LeaveGroup (const ARM_ETH_MAC_ADDR *ptr_addr) {
+  int32_t  idx;
+  uint32_t bin;
+
+  if (!ptr_addr) {
+    /* Invalid parameters */
+    return ARM_DRIVER_ERROR_PARAMETER;
+  }
+
+  if (!(emac.flags & EMAC_FLAG_POWER)) {
+    /* Driver not yet powered */
+    return ARM_DRIVER_ERROR;
+  }
+
+  idx = mcast_find (&ptr_addr->b[0]);
+  if (idx < 0) {
+    /* Not joined */
+    return ARM_DRIVER_ERROR;
   }
 
-  /* Enable Rx Filter */
-  LPC_EMAC->RxFilterCtrl |= (RFC_UCAST_HASH_EN | RFC_MCAST_HASH_EN);
+  if (--Mcast_ref[idx]) {
+    return ARM_DRIVER_OK;
+  }
+  Mcast_num--;
+
+  /* The last group in a bin closes it */
+  bin = hash_index (&ptr_addr->b[0]);
+  if (--Hash_ref[bin] == 0U) {
+    hash_set (bin, false);
+  }
+  if (Mcast_num == 0U) {
+    LPC_EMAC->RxFilterCtrl &= ~RFC_MCAST_HASH_EN;
+  }
 
   return ARM_DRIVER_OK;
 }
@@ -774,7 +1163,7 @@ static int32_t SetAddressFilter (const ARM_ETH_MAC_ADDR *ptr_addr, uint32_t num_
 */
 static int32_t SendFrame (const uint8_t *frame, uint32_t len, uint32_t flags) {
   uint8_t *dst;
-  uint32_t idx;
+  uint32_t idx, sum;
 
   if (!frame || !len) {
     /* Invalid parameters */
@@ -787,25 +1176,44 @@ static int32_t SendFrame (const uint8_t *frame, uint32_t len, uint32_t flags) {
   }
 
   dst = emac.frame_end;
-  idx = LPC_EMAC->TxProduceIndex;
+  idx = tx_next_desc ();
   if (dst == NULL) {
+    if (!tx_desc_free (idx)) {
+      /* All descriptors in use */
+      emac_stats.tx_busy++;
+      return ARM_DRIVER_ERROR_BUSY;
+    }
+    /* Descriptor may still point at a buffer loaned before */
+    Tx_Desc[idx].Packet = (uint8_t *)&tx_buf[idx];
     dst = Tx_Desc[idx].Packet;
     emac.frame_len = len;
+    emac.frame_sum = 0U;
   }
   else {
     /* Sending data fragments in progress */
     emac.frame_len += len;
   }
-  /* Fast-copy data fragments to EMAC-DMA buffer */
-  for ( ; len > 7U; dst += 8U, frame += 8U, len -= 8U) {
-    __UNALIGNED_UINT32_WRITE(&dst[0], __UNALIGNED_UINT32_READ(&frame[0]));
-    __UNALIGNED_UINT32_WRITE(&dst[4], __UNALIGNED_UINT32_READ(&frame[4]));
+  if (emac.flags & EMAC_FLAG_CSUM_TX) {
+    /* Copy and sum in one pass, fragments may start at an odd offset */
+    sum = IP_CSUM_Copy (0U, dst, frame, len);
+    if ((emac.frame_len - len) & 1U) {
+      sum = IP_CSUM_Swap (sum);
+    }
+    emac.frame_sum = IP_CSUM_Merge (emac.frame_sum, sum);
+    dst += len;
   }
-  /* Copy remaining 7 bytes */
-  for ( ; len > 1U; dst += 2U, frame += 2U, len -= 2U) {
-    __UNALIGNED_UINT16_WRITE(&dst[0], __UNALIGNED_UINT16_READ(&frame[0]));
+  else {
+    /* Fast-copy data fragments to EMAC-DMA buffer */
+    for ( ; len > 7U; dst += 8U, frame += 8U, len -= 8U) {
+      __UNALIGNED_UINT32_WRITE(&dst[0], __UNALIGNED_UINT32_READ(&frame[0]));
+      __UNALIGNED_UINT32_WRITE(&dst[4], __UNALIGNED_UINT32_READ(&frame[4]));
+    }
+    /* Copy remaining 7 bytes */
+    for ( ; len > 1U; dst += 2U, frame += 2U, len -= 2U) {
+      __UNALIGNED_UINT16_WRITE(&dst[0], __UNALIGNED_UINT16_READ(&frame[0]));
+    }
+    if (len > 0U) dst++[0] = frame++[0];
   }
-  if (len > 0U) dst++[0] = frame++[0];
 
   if (flags & ARM_ETH_MAC_TX_FRAME_FRAGMENT) {
     /* More data to come, remember current write position */
@@ -815,16 +1223,153 @@ static int32_t SendFrame (const uint8_t *frame, uint32_t len, uint32_t flags) {
 
   Tx_Desc[idx].Ctrl = (emac.frame_len-1U) | (TCTRL_INT | TCTRL_LAST);
 
+  if (emac.flags & EMAC_FLAG_CSUM_TX) {
+    if (emac.tx_frags == 0U) {
+      /* Whole frame is in the buffer, summed while copying */
+      IP_CSUM_FrameInsert (Tx_Desc[idx].Packet, emac.frame_len, emac.frame_sum);
+    }
+    else {
+      /* Loaned fragments in front */
+      tx_csum_chain (idx);
+    }
+  }
+
   emac.frame_end = NULL;
   emac.frame_len = 0U;
 
-  /* Start frame transmission. */
-  if (++idx == NUM_TX_BUF) idx = 0U;
-  LPC_EMAC->TxProduceIndex = idx;
+  tx_start_frame (idx);
+
+  return ARM_DRIVER_OK;
+}
+
+/**
+  \fn          int32_t EMAC_TxFrameLoan (const uint8_t *frame, uint32_t len, uint32_t flags)
+  \brief       Send Ethernet frame fragment from the caller's buffer without copying it.
+  \param[in]   frame  Pointer to frame buffer with data to send
+  \param[in]   len    Frame buffer length in bytes
+  \param[in]   flags  Frame transmit flags (see ARM_ETH_MAC_TX_FRAME_...)
+  \return      \ref execution_status
+*/
+int32_t EMAC_TxFrameLoan (const uint8_t *frame, uint32_t len, uint32_t flags) {
+  uint32_t idx;
+
+  if (!frame || !len || (len > (TCTRL_SIZE + 1U))) {
+    /* Invalid parameters */
+    return ARM_DRIVER_ERROR_PARAMETER;
+  }
+
+  if (((uint32_t)frame < (uint32_t)__base_RAM2) ||
+      (len > ((uint32_t)__top_RAM2 - (uint32_t)frame))) {
+    /* Buffer out of EMAC DMA reach */
+    return ARM_DRIVER_ERROR_PARAMETER;
+  }
+
+  if (!(emac.flags & EMAC_FLAG_POWER)) {
+    /* Driver not yet powered */
+    return ARM_DRIVER_ERROR;
+  }
+
+  if (emac.frame_end != NULL) {
+    /* Fragments copied by SendFrame go out in a descriptor of their own */
+    idx = tx_next_desc ();
+    Tx_Desc[idx].Ctrl = emac.frame_len - 1U;
+    emac.frame_end = NULL;
+    emac.frame_len = 0U;
+    emac.tx_frags++;
+  }
+
+  idx = tx_next_desc ();
+  if (!tx_desc_free (idx)) {
+    /* All descriptors in use */
+    emac_stats.tx_busy++;
+    return ARM_DRIVER_ERROR_BUSY;
+  }
+
+  Tx_Desc[idx].Packet = (uint8_t *)frame;
+  Tx_loan[idx]        = 1U;
+
+  if (flags & ARM_ETH_MAC_TX_FRAME_FRAGMENT) {
+    /* More fragments to come, EMAC gathers them when the frame is started */
+    Tx_Desc[idx].Ctrl = len - 1U;
+    emac.tx_frags++;
+    return ARM_DRIVER_OK;
+  }
+
+  Tx_Desc[idx].Ctrl = (len - 1U) | (TCTRL_INT | TCTRL_LAST);
+
+  if (emac.flags & EMAC_FLAG_CSUM_TX) {
+    /* Checksum fields are written in the loaned buffers */
+    tx_csum_chain (idx);
+  }
+
+  tx_start_frame (idx);
+
+  return ARM_DRIVER_OK;
+}
+
+/**
+  \fn          int32_t EMAC_SetTxRelease (EMAC_TxRelease_t cb_release)
+  \brief       Set callback for buffers loaned with \ref EMAC_TxFrameLoan.
+  \param[in]   cb_release  Pointer to \ref EMAC_TxRelease_t, NULL to disable
+  \return      \ref execution_status
+*/
+int32_t EMAC_SetTxRelease (EMAC_TxRelease_t cb_release) {
+
+  if (!(emac.flags & EMAC_FLAG_INIT)) {
+    /* Driver not yet initialized */
+    return ARM_DRIVER_ERROR;
+  }
+
+  emac.tx_release = cb_release;
+
+  return ARM_DRIVER_OK;
+}
+
+/**
+  \fn          int32_t EMAC_SetRxPoll (uint32_t enable)
+  \brief       Set receive interrupt mode.
+  \param[in]   enable  0=interrupt per frame (default), 1=polled
+  \return      \ref execution_status
+*/
+int32_t EMAC_SetRxPoll (uint32_t enable) {
+
+  if (!(emac.flags & EMAC_FLAG_INIT)) {
+    /* Driver not yet initialized */
+    return ARM_DRIVER_ERROR;
+  }
+
+  if (enable) {
+    emac.flags |= EMAC_FLAG_RX_POLL;
+  } else {
+    emac.flags &= ~EMAC_FLAG_RX_POLL;
+    if (emac.flags & EMAC_FLAG_POWER) {
+      LPC_EMAC->IntEnable |= INT_RX_DONE;
+    }
+  }
 
   return ARM_DRIVER_OK;
 }
 
+/**
+  \fn          int32_t EMAC_RxIrqEnable (void)
+  \brief       Unmask the receive interrupt in polled mode.
+  \return      1 when frames are waiting, 0 when empty or \ref execution_status
+*/
+int32_t EMAC_RxIrqEnable (void) {
+
+  if (!(emac.flags & EMAC_FLAG_POWER)) {
+    /* Driver not yet powered */
+    return ARM_DRIVER_ERROR;
+  }
+
+  /* Drop the status latched while masked, then look at the ring again.
+     The ISR leaves IntEnable alone while Rx is masked. */
+  LPC_EMAC->IntClear   = INT_RX_DONE;
+  LPC_EMAC->IntEnable |= INT_RX_DONE;
+
+  return ((LPC_EMAC->RxConsumeIndex != LPC_EMAC->RxProduceIndex) ? 1 : 0);
+}
+
 /**
   \fn          int32_t ReadFrame (uint8_t *frame, uint32_t len)
   \brief       Read data of received Ethernet frame.
@@ -836,8 +1381,9 @@ static int32_t SendFrame (const uint8_t *frame, uint32_t len, uint32_t flags) {
 */
 static int32_t ReadFrame (uint8_t *frame, uint32_t len) {
   uint8_t const *src;
-  uint32_t idx;
+  uint32_t idx, sum;
   int32_t cnt = (int32_t)len;
+  bool valid = true;
 
   if (!frame && len) {
     /* Invalid parameters */
@@ -851,21 +1397,39 @@ static int32_t ReadFrame (uint8_t *frame, uint32_t len) {
 
   idx = LPC_EMAC->RxConsumeIndex;
   src = (uint8_t const *)Rx_Desc[idx].Packet;
-  /* Fast-copy data to packet buffer */
-  for ( ; len > 7U; frame += 8U, src += 8U, len -= 8U) {
-    __UNALIGNED_UINT32_WRITE(&frame[0], __UNALIGNED_UINT32_READ(&src[0]));
-    __UNALIGNED_UINT32_WRITE(&frame[4], __UNALIGNED_UINT32_READ(&src[4]));
+  if (len && mcast_reject (Rx_Stat[idx].Info, src)) {
+    /* Group not joined, only shares a hash bin */
+    valid = false;
   }
-  /* Copy remaining 7 bytes */
-  for ( ; len > 1U; frame += 2U, src += 2U, len -= 2U) {
-    __UNALIGNED_UINT16_WRITE(&frame[0], __UNALIGNED_UINT16_READ(&src[0]));
+  else if ((emac.flags & EMAC_FLAG_CSUM_RX) && len) {
+    /* Copy and sum in one pass, only a complete frame can be checked */
+    sum = IP_CSUM_Copy (0U, frame, src, len);
+    if (len == ((Rx_Stat[idx].Info & RINFO_SIZE) - 3U)) {
+      valid = IP_CSUM_FrameCheck (frame, len, sum);
+    }
+  }
+  else {
+    /* Fast-copy data to packet buffer */
+    for ( ; len > 7U; frame += 8U, src += 8U, len -= 8U) {
+      __UNALIGNED_UINT32_WRITE(&frame[0], __UNALIGNED_UINT32_READ(&src[0]));
+      __UNALIGNED_UINT32_WRITE(&frame[4], __UNALIGNED_UINT32_READ(&src[4]));
+    }
+    /* Copy remaining 7 bytes */
+    for ( ; len > 1U; frame += 2U, src += 2U, len -= 2U) {
+      __UNALIGNED_UINT16_WRITE(&frame[0], __UNALIGNED_UINT16_READ(&src[0]));
+    }
+    if (len > 0U) frame[0] = src[0];
   }
-  if (len > 0U) frame[0] = src[0];
 
+  rx_count (idx, valid && (cnt != 0));
   if (++idx == NUM_RX_BUF) idx = 0U;
   /* Release frame from EMAC buffer */
   LPC_EMAC->RxConsumeIndex = idx;
 
+  if (!valid) {
+    /* Checksum error or unwanted group, frame dropped */
+    return ARM_DRIVER_ERROR;
+  }
   return (cnt);
 }
 
@@ -897,21 +1461,147 @@ static uint32_t GetRxFrameSize (void) {
   return ((info & RINFO_SIZE) - 3U);
 }
 
+/**
+  \fn          int32_t EMAC_RxFrameLoan (uint8_t **frame)
+  \brief       Take the received Ethernet frame without copying it.
+  \param[out]  frame  Pointer where the frame buffer address is written to
+  \return      number of data bytes in the frame or execution status
+                 - value > 0: frame length, the buffer is owned by the caller
+                 - value = 0: no frame received
+                 - value < 0: error occurred, value is execution status as defined with \ref execution_status 
+*/
+int32_t EMAC_RxFrameLoan (uint8_t **frame) {
+  uint32_t info, idx, val, buf, loan, size;
+
+  if (!frame) {
+    /* Invalid parameters */
+    return ARM_DRIVER_ERROR_PARAMETER;
+  }
+
+  if (!(emac.flags & EMAC_FLAG_POWER)) {
+    /* Driver not yet powered */
+    return ARM_DRIVER_ERROR;
+  }
+
+  idx = LPC_EMAC->RxConsumeIndex;
+  if (idx == LPC_EMAC->RxProduceIndex) {
+    /* No packet received */
+    return (0);
+  }
+
+  info = Rx_Stat[idx].Info;
+  size = (info & RINFO_SIZE) - 3U;
+  if (!(info & RINFO_LAST_FLAG) || (info & RINFO_ERR_MASK) ||
+      mcast_reject (info, Rx_Desc[idx].Packet) ||
+      ((emac.flags & EMAC_FLAG_CSUM_RX) &&
+       !IP_CSUM_FrameCheck (Rx_Desc[idx].Packet, size, IP_CSUM_Add (0U, Rx_Desc[idx].Packet, size)))) {
+    /* Error, drop the frame and keep the buffer */
+    rx_count (idx, false);
+    if (++idx == NUM_RX_BUF) idx = 0U;
+    LPC_EMAC->RxConsumeIndex = idx;
+    return ARM_DRIVER_ERROR;
+  }
+
+  /* Take a spare buffer for the descriptor */
+  do {
+    val = __LDREXW (&Rx_free);
+    if (val == 0U) {
+      /* All spares on loan, ReadFrame still works */
+      __CLREX ();
+      return ARM_DRIVER_ERROR_BUSY;
+    }
+    buf = 31U - __CLZ (val);
+  } while (__STREXW (val & ~(1U << buf), &Rx_free));
+
+  rx_count (idx, true);
+  *frame = (uint8_t *)Rx_Desc[idx].Packet;
+  Rx_Desc[idx].Packet = (uint8_t *)&rx_buf[buf];
+
+  /* Returns may come from any context */
+  loan = (uint32_t)(*frame - (uint8_t *)&rx_buf[0]) / sizeof (rx_buf[0]);
+  while (__STREXW ((__LDREXW (&Rx_loan) | (1U << loan)), &Rx_loan));
+
+  if (++idx == NUM_RX_BUF) idx = 0U;
+  /* Hand the descriptor back to EMAC with the fresh buffer */
+  LPC_EMAC->RxConsumeIndex = idx;
+
+  return ((int32_t)size);
+}
+
+/**
+  \fn          int32_t EMAC_RxFrameReturn (uint8_t *frame)
+  \brief       Return a frame buffer taken with \ref EMAC_RxFrameLoan.
+  \param[in]   frame  Frame buffer address
+  \return      \ref execution_status
+*/
+int32_t EMAC_RxFrameReturn (uint8_t *frame) {
+  uint32_t buf, val;
+
+  buf = (uint32_t)(frame - (uint8_t *)&rx_buf[0]) / sizeof (rx_buf[0]);
+  if ((frame < (uint8_t *)&rx_buf[0]) || (buf >= (NUM_RX_BUF + NUM_RX_LOAN)) ||
+      (frame != (uint8_t *)&rx_buf[buf])) {
+    /* Not a frame buffer */
+    return ARM_DRIVER_ERROR_PARAMETER;
+  }
+
+  /* Only once per loan, a second return would free a buffer in use */
+  do {
+    val = __LDREXW (&Rx_loan);
+    if (!(val & (1U << buf))) {
+      __CLREX ();
+      return ARM_DRIVER_ERROR_PARAMETER;
+    }
+  } while (__STREXW (val & ~(1U << buf), &Rx_loan));
+
+  while (__STREXW ((__LDREXW (&Rx_free) | (1U << buf)), &Rx_free));
+
+  return ARM_DRIVER_OK;
+}
+
 /* Ethernet IRQ Handler */
 void ENET_IRQHandler (void) {
   /* EMAC Ethernet Controller Interrupt function. */
   uint32_t int_stat;
   uint32_t event = 0U;
+  uint32_t idx, end;
 
   int_stat = (LPC_EMAC->IntStatus & LPC_EMAC->IntEnable);
   LPC_EMAC->IntClear = int_stat;
   
   if (int_stat & INT_RX_DONE) {
     /* Packet received, check if packet is valid. */
+    if (emac.flags & EMAC_FLAG_RX_POLL) {
+      /* Polled mode, masked until the Rx ring is drained */
+      LPC_EMAC->IntEnable &= ~INT_RX_DONE;
+    }
     event |= ARM_ETH_MAC_EVENT_RX_FRAME;
   }
+  if (int_stat & (INT_RX_FIN | INT_RX_OVERRUN)) {
+    /* EMAC used the last free Rx descriptor, or lost a frame with none left */
+    emac_stats.rx_ring_full++;
+  }
   if (int_stat & INT_TX_DONE) {
-    /* Frame transmit completed. */
+    /* Frame transmit completed, give loaned buffers back. */
+    end = LPC_EMAC->TxConsumeIndex;
+    for (idx = emac.tx_done; idx != end; ) {
+      emac_stats.tx_bytes += (Tx_Desc[idx].Ctrl & TCTRL_SIZE) + 1U;
+      if (Tx_Desc[idx].Ctrl & TCTRL_LAST) {
+        if (Tx_Stat[idx].Info & TINFO_ERR) {
+          emac_stats.tx_errors++;
+        }
+        else {
+          emac_stats.tx_frames++;
+        }
+      }
+      if (Tx_loan[idx]) {
+        Tx_loan[idx] = 0U;
+        if (emac.tx_release) {
+          emac.tx_release (Tx_Desc[idx].Packet);
+        }
+      }
+      if (++idx == NUM_TX_BUF) idx = 0U;
+    }
+    emac.tx_done = (uint8_t)end;
     event |= ARM_ETH_MAC_EVENT_TX_FRAME;
   }
   /* Callback event notification */
@@ -994,10 +1684,13 @@ static int32_t Control (uint32_t control, uint32_t arg) {
         mac1 |= MAC1_LOOPB;
       }
 
-      if ((arg & ARM_ETH_MAC_CHECKSUM_OFFLOAD_RX) ||
-          (arg & ARM_ETH_MAC_CHECKSUM_OFFLOAD_TX)) {
-        /* Checksum offload is disabled in the driver */
-        return ARM_DRIVER_ERROR_UNSUPPORTED;
+      /* Configure checksum offload, done in the driver frame copy */
+      emac.flags &= ~(EMAC_FLAG_CSUM_RX | EMAC_FLAG_CSUM_TX);
+      if (arg & ARM_ETH_MAC_CHECKSUM_OFFLOAD_RX) {
+        emac.flags |= EMAC_FLAG_CSUM_RX;
+      }
+      if (arg & ARM_ETH_MAC_CHECKSUM_OFFLOAD_TX) {
+        emac.flags |= EMAC_FLAG_CSUM_TX;
       }
 
       LPC_EMAC->SUPP    = supp;
@@ -1143,6 +1836,9 @@ static int32_t PHY_Read (uint8_t phy_addr, uint8_t reg_addr, uint16_t *data) {
     tick = osKernelGetSysTimerCount();
 #elif defined(RTE_CMSIS_RTOS)
     tick = osKernelSysTick();
+#else
+    /* Each poll takes at least one core clock */
+    tick = PHY_TIMEOUT * (SystemCoreClock / 1000000U);
 #endif
     do {
       if ((LPC_EMAC->MIND & MIND_BUSY) == 0U) break;
@@ -1150,6 +1846,8 @@ static int32_t PHY_Read (uint8_t phy_addr, uint8_t reg_addr, uint16_t *data) {
     } while ((osKernelGetSysTimerCount() - tick) < (((uint64_t)PHY_TIMEOUT * osKernelGetSysTimerFreq()) / 1000000U));
 #elif defined(RTE_CMSIS_RTOS)
     } while ((osKernelSysTick() - tick) < osKernelSysTickMicroSec(PHY_TIMEOUT));
+#else
+    } while (--tick);
 #endif
 
     if ((LPC_EMAC->MIND & MIND_BUSY) == 0U) {
@@ -1214,6 +1912,9 @@ static int32_t PHY_Write (uint8_t phy_addr, uint8_t reg_addr, uint16_t data) {
     tick = osKernelGetSysTimerCount();
 #elif defined(RTE_CMSIS_RTOS)
     tick = osKernelSysTick();
+#else
+    /* Each poll takes at least one core clock */
+    tick = PHY_TIMEOUT * (SystemCoreClock / 1000000U);
 #endif
     do {
       if ((LPC_EMAC->MIND & MIND_BUSY) == 0U) break;
@@ -1221,6 +1922,8 @@ static int32_t PHY_Write (uint8_t phy_addr, uint8_t reg_addr, uint16_t data) {
     } while ((osKernelGetSysTimerCount() - tick) < (((uint64_t)PHY_TIMEOUT * osKernelGetSysTimerFreq()) / 1000000U));
 #elif defined(RTE_CMSIS_RTOS)
     } while ((osKernelSysTick() - tick) < osKernelSysTickMicroSec(PHY_TIMEOUT));
+#else
+    } while (--tick);
 #endif
     
     if ((LPC_EMAC->MIND & MIND_BUSY) == 0U) {
@@ -1230,6 +1933,122 @@ static int32_t PHY_Write (uint8_t phy_addr, uint8_t reg_addr, uint16_t data) {
   return ARM_DRIVER_ERROR_TIMEOUT;
 }
 
+/**
+  \fn          int32_t EMAC_GetStats (EMAC_STATS *stats)
+  \brief       Get statistics counters.
+  \param[out]  stats  Pointer where the counters are copied to
+  \return      \ref execution_status
+*/
+int32_t EMAC_GetStats (EMAC_STATS *stats) {
+
+  if (!stats) {
+    /* Invalid parameter */
+    return ARM_DRIVER_ERROR_PARAMETER;
+  }
+
+  *stats = emac_stats;
+
+  return ARM_DRIVER_OK;
+}
+
+/**
+  \fn          int32_t EMAC_PHY_ReadStart (uint8_t phy_addr, uint8_t reg_addr)
+  \brief       Start reading Ethernet PHY Register through Management Interface.
+  \param[in]   phy_addr  5-bit device address
+  \param[in]   reg_addr  5-bit register address
+  \return      \ref execution_status
+*/
+int32_t EMAC_PHY_ReadStart (uint8_t phy_addr, uint8_t reg_addr) {
+
+  if (!(emac.flags & EMAC_FLAG_POWER)) {
+    /* Driver not powered */
+    return ARM_DRIVER_ERROR;
+  }
+
+  if (emac.dev_175x == true) {
+    /* Software MII Management, the frame is clocked here */
+    emac.mii_read = false;
+    return PHY_Read (phy_addr, reg_addr, &emac.mii_data);
+  }
+
+  if (LPC_EMAC->MIND & MIND_BUSY) {
+    /* Previous operation not completed */
+    return ARM_DRIVER_ERROR_BUSY;
+  }
+
+  LPC_EMAC->MADR = (uint32_t)(phy_addr << 8) | reg_addr;
+  LPC_EMAC->MCMD = MCMD_READ;
+  emac.mii_read  = true;
+
+  return ARM_DRIVER_OK;
+}
+
+/**
+  \fn          int32_t EMAC_PHY_WriteStart (uint8_t phy_addr, uint8_t reg_addr, uint16_t data)
+  \brief       Start writing Ethernet PHY Register through Management Interface.
+  \param[in]   phy_addr  5-bit device address
+  \param[in]   reg_addr  5-bit register address
+  \param[in]   data      16-bit data to write
+  \return      \ref execution_status
+*/
+int32_t EMAC_PHY_WriteStart (uint8_t phy_addr, uint8_t reg_addr, uint16_t data) {
+
+  if (!(emac.flags & EMAC_FLAG_POWER)) {
+    /* Driver not powered */
+    return ARM_DRIVER_ERROR;
+  }
+
+  emac.mii_read = false;
+  if (emac.dev_175x == true) {
+    /* Software MII Management, the frame is clocked here */
+    return PHY_Write (phy_addr, reg_addr, data);
+  }
+
+  if (LPC_EMAC->MIND & MIND_BUSY) {
+    /* Previous operation not completed */
+    return ARM_DRIVER_ERROR_BUSY;
+  }
+
+  LPC_EMAC->MCMD = 0U;
+  LPC_EMAC->MADR = (uint32_t)(phy_addr << 8) | reg_addr;
+  LPC_EMAC->MWTD = data;
+
+  return ARM_DRIVER_OK;
+}
+
+/**
+  \fn          int32_t EMAC_PHY_Poll (uint16_t *data)
+  \brief       Check for completion of a started PHY Register access.
+  \param[out]  data      Pointer where the read result is written to
+  \return      \ref execution_status, ARM_DRIVER_ERROR_BUSY while in progress
+*/
+int32_t EMAC_PHY_Poll (uint16_t *data) {
+
+  if (!data) {
+    /* Invalid parameter */
+    return ARM_DRIVER_ERROR_PARAMETER;
+  }
+
+  if (!(emac.flags & EMAC_FLAG_POWER)) {
+    /* Driver not powered */
+    return ARM_DRIVER_ERROR;
+  }
+
+  if (emac.dev_175x == false) {
+    if (LPC_EMAC->MIND & MIND_BUSY) {
+      return ARM_DRIVER_ERROR_BUSY;
+    }
+    if (emac.mii_read) {
+      LPC_EMAC->MCMD = 0U;
+      emac.mii_data  = (uint16_t)LPC_EMAC->MRDD;
+      emac.mii_read  = false;
+    }
+  }
+  *data = emac.mii_data;
+
+  return ARM_DRIVER_OK;
+}
+
 /* MAC Driver Control Block */
 ARM_DRIVER_ETH_MAC Driver_ETH_MAC0 = {
   GetVersion,
@@ -17,13 +17,28 @@
  * limitations under the License.
  *
  *
- * $Date:        10. Januar 2020
- * $Revision:    V1.4
+ * $Date:        17. October 2026
+ * $Revision:    V1.10
  *
  * Project:      GPDMA Driver for NXP LPC17xx
  * -------------------------------------------------------------------------- */
 
 /* History:
+ *  Version 1.10
+ *    - Channel pool leaves out the channels RTE_Device.h assigns to drivers
+ *  Version 1.9
+ *    - GPDMA_ChannelConfigureChain rejects circular link lists
+ *  Version 1.8
+ *    - DMA_IRQHandler reads the status registers once and walks the set bits
+ *    - Added optional interrupt entry to callback latency (GPDMA_IRQ_LATENCY)
+ *  Version 1.7
+ *    - Added circular transfers with half and full transfer events
+ *  Version 1.6
+ *    - Added channel pool with priority classes
+ *  Version 1.5
+ *    - Added link list (scatter-gather) transfers
+ *    - Transfers bigger than 4k run from a driver owned link list and
+ *      signal a single terminal count interrupt
  *  Version 1.4
  *    - Removed minor compiler warnings
  *  Version 1.3
@@ -34,7 +49,10 @@
  *    - Updated Initialize and Uninitialize functions
  */
 
+#include <stddef.h>
+
 #include "GPDMA_LPC17xx.h"
+#include "RTE_Device.h"
 
 #if defined (LPC175x_6x)
   #include "LPC17xx.h"
@@ -76,6 +94,8 @@ typedef struct {
   uint32_t            DestAddr;
   uint32_t            Size;
   uint32_t            Cnt;
+  uint32_t            Control;
+  uint32_t            Half;     // Items per half of a circular transfer, 0 otherwise
   GPDMA_SignalEvent_t cb_event;
 } GPDMA_Channel_Info;
 
@@ -83,10 +103,53 @@ typedef struct {
 
 
 static uint32_t Channel_active = 0U;
+static uint32_t Channel_alloc  = 0U;
 static uint32_t Init_cnt       = 0U;
 
 static GPDMA_Channel_Info Channel_info[GPDMA_NUMBER_OF_CHANNELS] = { 0U };
 
+#if (GPDMA_IRQ_LATENCY != 0U)
+typedef struct {
+  uint32_t            Last;
+  uint32_t            Max;
+} GPDMA_Channel_Latency;
+
+static GPDMA_Channel_Latency Channel_latency[GPDMA_NUMBER_OF_CHANNELS];
+#endif
+
+// First channel of each priority class, channel 0 has the highest priority
+static const uint8_t Prio_first[] = { 0U, 2U, 5U };
+
+// Channel a driver uses with a fixed number, when the driver and its DMA
+// are enabled in RTE_Device.h
+#define GPDMA_FIXED_CH(en, dma_en, ch)  ((((en) != 0) && ((dma_en) != 0) &&      \
+                                          !GPDMA_CHANNEL_IS_POOL(ch)) ?           \
+                                         (1U << ((ch) & 7U)) : 0U)
+
+// Channels the pool never hands out
+#if defined (LPC175x_6x)
+#define GPDMA_CHANNEL_FIXED_MASK                                                \
+  (GPDMA_FIXED_CH(RTE_UART0, RTE_UART0_DMA_TX_EN, RTE_UART0_DMA_TX_CH) |         \
+   GPDMA_FIXED_CH(RTE_UART0, RTE_UART0_DMA_RX_EN, RTE_UART0_DMA_RX_CH) |         \
+   GPDMA_FIXED_CH(RTE_UART1, RTE_UART1_DMA_TX_EN, RTE_UART1_DMA_TX_CH) |         \
+   GPDMA_FIXED_CH(RTE_UART1, RTE_UART1_DMA_RX_EN, RTE_UART1_DMA_RX_CH) |         \
+   GPDMA_FIXED_CH(RTE_UART2, RTE_UART2_DMA_TX_EN, RTE_UART2_DMA_TX_CH) |         \
+   GPDMA_FIXED_CH(RTE_UART2, RTE_UART2_DMA_RX_EN, RTE_UART2_DMA_RX_CH) |         \
+   GPDMA_FIXED_CH(RTE_UART3, RTE_UART3_DMA_TX_EN, RTE_UART3_DMA_TX_CH) |         \
+   GPDMA_FIXED_CH(RTE_UART3, RTE_UART3_DMA_RX_EN, RTE_UART3_DMA_RX_CH) |         \
+   GPDMA_FIXED_CH(RTE_SSP0,  RTE_SSP0_DMA_TX_EN,  RTE_SSP0_DMA_TX_CH)  |         \
+   GPDMA_FIXED_CH(RTE_SSP0,  RTE_SSP0_DMA_RX_EN,  RTE_SSP0_DMA_RX_CH)  |         \
+   GPDMA_FIXED_CH(RTE_SSP1,  RTE_SSP1_DMA_TX_EN,  RTE_SSP1_DMA_TX_CH)  |         \
+   GPDMA_FIXED_CH(RTE_SSP1,  RTE_SSP1_DMA_RX_EN,  RTE_SSP1_DMA_RX_CH)  |         \
+   GPDMA_FIXED_CH(RTE_I2S0,  RTE_I2S0_DMA_TX_EN,  RTE_I2S0_DMA_TX_CH)  |         \
+   GPDMA_FIXED_CH(RTE_I2S0,  RTE_I2S0_DMA_RX_EN,  RTE_I2S0_DMA_RX_CH))
+#else
+#define GPDMA_CHANNEL_FIXED_MASK        (0U)
+#endif
+
+// Driver owned link lists, GPDMA can not fetch items from local SRAM
+static GPDMA_LLI Channel_lli[GPDMA_NUMBER_OF_CHANNELS][GPDMA_CHANNEL_LLI_NUM] __attribute__((section(".bss.$RAM2")));
+
 #define GPDMA_CHANNEL(n)  ((GPDMA_CHANNEL_REG *) (&(GPDMACH0->SRCADDR) + (n * 8U)))
 #define LPC17xx_GPDMA     ((GPDMA_REG         *) LPC_GPDMA_BASE)
 
@@ -124,6 +187,129 @@ __inline static void Clear_Channel_active_flag (uint8_t ch) {
   while(__STREXW((__LDREXW(&Channel_active) & ~(1U << ch)), &Channel_active));
 }
 
+/**
+  \fn          int32_t Set_Channel_alloc_flag (uint8_t ch)
+  \brief       Protected set of channel allocated flag
+  \param[in]   ch        Channel number (0..7)
+  \returns
+   - \b  0: function succeeded
+   - \b -1: function failed
+*/
+__inline static int32_t Set_Channel_alloc_flag (uint8_t ch) {
+  uint32_t val;
+
+  do {
+    val = __LDREXW (&Channel_alloc);
+    if ((val | Channel_active) & (1U << ch)) {
+      __CLREX ();
+      return -1;
+    }
+  } while (__STREXW (val | (1U << ch), &Channel_alloc));
+
+  return 0;
+}
+
+/**
+  \fn          void Signal_Event (uint32_t ch, uint32_t event, uint32_t entry)
+  \brief       Signal channel event and record the latency since interrupt entry
+  \param[in]   ch        Channel number (0..7)
+  \param[in]   event     GPDMA Event mask
+  \param[in]   entry     DWT cycle count at interrupt entry
+*/
+__inline static void Signal_Event (uint32_t ch, uint32_t event, uint32_t entry) {
+#if (GPDMA_IRQ_LATENCY != 0U)
+  uint32_t lat = DWT->CYCCNT - entry;
+
+  Channel_latency[ch].Last = lat;
+  if (lat > Channel_latency[ch].Max) { Channel_latency[ch].Max = lat; }
+#else
+  (void)entry;
+#endif
+
+  if (Channel_info[ch].cb_event) {
+    Channel_info[ch].cb_event(event);
+  }
+}
+
+/**
+  \fn          int32_t Chain_Size (const GPDMA_LLI *lli)
+  \brief       Get number of data items left in a link list
+  \param[in]   lli       First item of link list
+  \returns
+   - \b >=0: number of data items
+   - \b  -1: list does not terminate
+*/
+static int32_t Chain_Size (const GPDMA_LLI *lli) {
+  const GPDMA_LLI *fast = lli;
+  uint32_t size = 0U;
+
+  while (lli != NULL) {
+    size += lli->Control & GPDMA_CH_CONTROL_TRANSFERSIZE_MSK;
+    lli   = (const GPDMA_LLI *)lli->Next;
+
+    // A second walk at twice the pace catches up on a circular list
+    if (fast != NULL) { fast = (const GPDMA_LLI *)fast->Next; }
+    if (fast != NULL) { fast = (const GPDMA_LLI *)fast->Next; }
+    if ((fast != NULL) && (fast == lli)) { return -1; }
+  }
+
+  return (int32_t)size;
+}
+
+/**
+  \fn          void Channel_Load (uint8_t ch)
+  \brief       Load next part of a transfer into the channel link list and
+               the channel registers
+  \param[in]   ch        Channel number (0..7)
+*/
+static void Channel_Load (uint8_t ch) {
+  GPDMA_CHANNEL_REG  * dma_ch = GPDMA_CHANNEL(ch);
+  GPDMA_Channel_Info * info   = &Channel_info[ch];
+  GPDMA_LLI          * lli    = Channel_lli[ch];
+  uint32_t size;
+
+  size = info->Size - info->Cnt;
+  if (size > (GPDMA_CHANNEL_LLI_NUM * GPDMA_LLI_MAX_SIZE)) {
+    // Rest is loaded on terminal count of this part
+    size = GPDMA_CHANNEL_LLI_NUM * GPDMA_LLI_MAX_SIZE;
+  }
+
+  GPDMA_ChainBuild (lli, GPDMA_CHANNEL_LLI_NUM, info->SrcAddr, info->DestAddr, size, info->Control);
+
+  // First item goes straight to the channel registers
+  dma_ch->SRCADDR  = lli->SrcAddr;
+  dma_ch->DESTADDR = lli->DestAddr;
+  dma_ch->LLI      = lli->Next;
+  dma_ch->CONTROL  = lli->Control;
+
+  if (info->Control & GPDMA_CH_CONTROL_SI) {
+    // Source address increment
+    info->SrcAddr  += (size << ((info->Control & GPDMA_CH_CONTROL_SWIDTH_MSK) >> GPDMA_CH_CONTROL_SWIDTH_POS));
+  }
+  if (info->Control & GPDMA_CH_CONTROL_DI) {
+    // Destination address increment
+    info->DestAddr += (size << ((info->Control & GPDMA_CH_CONTROL_DWIDTH_MSK) >> GPDMA_CH_CONTROL_DWIDTH_POS));
+  }
+
+  info->Cnt += size;
+}
+
+/**
+  \fn          uint32_t Circular_Item (uint8_t ch)
+  \brief       Get link list item a circular transfer is running
+  \param[in]   ch        Channel number (0..7)
+  \returns     Item index
+*/
+static uint32_t Circular_Item (uint8_t ch) {
+  uint32_t num, next;
+
+  num  = Channel_info[ch].Half * 2U;
+  next = (GPDMA_CHANNEL(ch)->LLI - (uint32_t)Channel_lli[ch]) / sizeof(GPDMA_LLI);
+
+  // Channel register holds the item after the running one
+  return ((next + num - 1U) % num);
+}
+
 /**
   \fn          int32_t GPDMA_Initialize (void)
   \brief       Initialize GPDMA peripheral
@@ -149,8 +335,12 @@ int32_t GPDMA_Initialize (void) {
     Channel_info[ch_num].DestAddr = 0U;
     Channel_info[ch_num].Size     = 0U;
     Channel_info[ch_num].Cnt      = 0U;
+    Channel_info[ch_num].Half     = 0U;
   }
 
+  // All channels back to the channel pool
+  Channel_alloc = 0U;
+
   // Clear all DMA interrupt flags
   LPC17xx_GPDMA->DMACIntTCClear = 0xFFU;
   LPC17xx_GPDMA->DMACIntErrClr  = 0xFFU;
@@ -213,6 +403,54 @@ int32_t GPDMA_PeripheralSelect (uint8_t peri, uint8_t sel) {
   return 0;
 }
 
+/**
+  \fn          int32_t GPDMA_ChannelAllocate (uint8_t prio)
+  \brief       Take a free channel from the channel pool
+  \param[in]   prio      Priority class (GPDMA_PRIO_HIGH..GPDMA_PRIO_LOW),
+                         a lower class is used when the class is exhausted
+  \returns
+   - \b  0..7: allocated channel number
+   - \b    -1: no channel free
+*/
+int32_t GPDMA_ChannelAllocate (uint8_t prio) {
+  uint8_t ch;
+
+  if (prio > GPDMA_PRIO_LOW) { return -1; }
+
+  // Highest priority free channel of the class, then of the lower classes
+  for (ch = Prio_first[prio]; ch < GPDMA_NUMBER_OF_CHANNELS; ch++) {
+    if ((GPDMA_CHANNEL_POOL_MASK & ~GPDMA_CHANNEL_FIXED_MASK & (1U << ch)) == 0U) { continue; }
+    if (Set_Channel_alloc_flag (ch) == 0)             { return ch; }
+  }
+
+  return -1;
+}
+
+/**
+  \fn          int32_t GPDMA_ChannelRelease (uint8_t ch)
+  \brief       Return channel to the channel pool
+  \param[in]   ch Channel number (0..7)
+  \returns
+   - \b  0: function succeeded
+   - \b -1: function failed, channel not allocated or still active
+*/
+int32_t GPDMA_ChannelRelease (uint8_t ch) {
+  uint32_t val;
+
+  // Check if channel is valid
+  if (ch >= GPDMA_NUMBER_OF_CHANNELS) { return -1; }
+
+  do {
+    val = __LDREXW (&Channel_alloc);
+    if (((val & (1U << ch)) == 0U) || (Channel_active & (1U << ch))) {
+      __CLREX ();
+      return -1;
+    }
+  } while (__STREXW (val & ~(1U << ch), &Channel_alloc));
+
+  return 0;
+}
+
 /**
   \fn          int32_t GPDMA_ChannelConfigure (uint8_t              ch,
                                                uint32_t             src_addr,
@@ -261,41 +499,266 @@ int32_t GPDMA_ChannelConfigure (uint8_t              ch,
   LPC17xx_GPDMA->DMACIntTCClear = (1U << ch);
   LPC17xx_GPDMA->DMACIntErrClr  = (1U << ch);
 
-  // Link list not supported
-  dma_ch->LLI = 0U;
+  // Enable DMA Channels, little endian
+  LPC17xx_GPDMA->DMACConfig = GPDMA_CONFIG_E;
+  while ((LPC17xx_GPDMA->DMACConfig & GPDMA_CONFIG_E) == 0U);
+
+  // Save channel information
+  Channel_info[ch].SrcAddr  = src_addr;
+  Channel_info[ch].DestAddr = dest_addr;
+  Channel_info[ch].Size     = size;
+  Channel_info[ch].Cnt      = 0U;
+  Channel_info[ch].Control  = control;
+  Channel_info[ch].Half     = 0U;
+
+  // Transfers bigger than 4k are split into link list items
+  Channel_Load (ch);
+
+  dma_ch->CONFIG  = config;
+
+  if ((config & GPDMA_CONFIG_E) == 0U) {
+    // Clear Channel active flag
+    Clear_Channel_active_flag (ch);
+  }
+
+  return 0;
+}
+
+/**
+  \fn          int32_t GPDMA_ChainBuild (GPDMA_LLI *lli,
+                                         uint32_t   num,
+                                         uint32_t   src_addr,
+                                         uint32_t   dest_addr,
+                                         uint32_t   size,
+                                         uint32_t   control)
+  \brief       Build link list for one buffer, split into 4k items
+  \param[out]  lli       Link list items
+  \param[in]   num       Number of items available in lli
+  \param[in]   src_addr  Source address
+  \param[in]   dest_addr Destination address
+  \param[in]   size      Amount of data to transfer
+  \param[in]   control   Channel control, terminal count interrupt
+                         (GPDMA_CH_CONTROL_I) is kept on the last item only
+  \returns
+   - \b  >0: number of items used
+   - \b  -1: function failed
+*/
+int32_t GPDMA_ChainBuild (GPDMA_LLI *lli,
+                          uint32_t   num,
+                          uint32_t   src_addr,
+                          uint32_t   dest_addr,
+                          uint32_t   size,
+                          uint32_t   control) {
+  uint32_t cnt, n;
+
+  // Items are fetched by the GPDMA and must be word aligned
+  if ((lli == NULL) || ((uint32_t)lli & 3U)) { return -1; }
+  if (num < GPDMA_LLI_NUM(size))            { return -1; }
+
+  control &= ~GPDMA_CH_CONTROL_TRANSFERSIZE_MSK;
+
+  cnt = 0U;
+  do {
+    n = (size > GPDMA_LLI_MAX_SIZE) ? GPDMA_LLI_MAX_SIZE : size;
+    size -= n;
+
+    lli[cnt].SrcAddr  = src_addr;
+    lli[cnt].DestAddr = dest_addr;
+    if (size != 0U) {
+      // Terminal count interrupt on the last item only
+      lli[cnt].Next    = (uint32_t)&lli[cnt + 1U];
+      lli[cnt].Control = (control & ~GPDMA_CH_CONTROL_I) | GPDMA_CH_CONTROL_TRANSFERSIZE(n);
+    } else {
+      lli[cnt].Next    = 0U;
+      lli[cnt].Control = control | GPDMA_CH_CONTROL_TRANSFERSIZE(n);
+    }
+
+    if (control & GPDMA_CH_CONTROL_SI) {
+      // Source address increment
+      src_addr  += (n << ((control & GPDMA_CH_CONTROL_SWIDTH_MSK) >> GPDMA_CH_CONTROL_SWIDTH_POS));
+    }
+    if (control & GPDMA_CH_CONTROL_DI) {
+      // Destination address increment
+      dest_addr += (n << ((control & GPDMA_CH_CONTROL_DWIDTH_MSK) >> GPDMA_CH_CONTROL_DWIDTH_POS));
+    }
+    cnt++;
+  } while (size != 0U);
+
+  return (int32_t)cnt;
+}
+
+/**
+  \fn          void GPDMA_ChainLink (GPDMA_LLI *tail, const GPDMA_LLI *next)
+  \brief       Link two lists into one transfer
+  \param[in]   tail      Last item of the first list
+  \param[in]   next      First item of the second list
+*/
+void GPDMA_ChainLink (GPDMA_LLI *tail, const GPDMA_LLI *next) {
+  tail->Next     = (uint32_t)next;
+  // Terminal count interrupt is left to the last item of the second list
+  tail->Control &= ~GPDMA_CH_CONTROL_I;
+}
+
+/**
+  \fn          int32_t GPDMA_ChannelConfigureChain (uint8_t              ch,
+                                                    const GPDMA_LLI     *lli,
+                                                    uint32_t             config,
+                                                    GPDMA_SignalEvent_t  cb_event)
+  \brief       Configure GPDMA channel for link list transfer
+  \param[in]   ch        Channel number (0..7)
+  \param[in]   lli       First item of a terminated link list
+  \param[in]   config    Channel configuration
+  \param[in]   cb_event  Channel callback pointer
+  \returns
+   - \b  0: function succeeded
+   - \b -1: function failed
+*/
+int32_t GPDMA_ChannelConfigureChain (uint8_t              ch,
+                                     const GPDMA_LLI     *lli,
+                                     uint32_t             config,
+                                     GPDMA_SignalEvent_t  cb_event) {
+  GPDMA_CHANNEL_REG * dma_ch;
+  int32_t size;
+
+  // Check if channel and link list are valid
+  if (ch >= GPDMA_NUMBER_OF_CHANNELS)     { return -1; }
+  if ((lli == NULL) || ((uint32_t)lli & 3U)) { return -1; }
+  size = Chain_Size (lli);
+  if (size < 0)                           { return -1; }
+
+  // Set Channel active flag
+  if (Set_Channel_active_flag (ch) == -1) { return -1; }
+
+  // Save callback pointer
+  Channel_info[ch].cb_event = cb_event;
+
+  dma_ch = GPDMA_CHANNEL(ch);
+
+  // Reset DMA Channel configuration
+  dma_ch->CONFIG  = 0U;
+  dma_ch->CONTROL = 0U;
+
+  // Clear DMA interrupts
+  LPC17xx_GPDMA->DMACIntTCClear = (1U << ch);
+  LPC17xx_GPDMA->DMACIntErrClr  = (1U << ch);
 
   // Enable DMA Channels, little endian
   LPC17xx_GPDMA->DMACConfig = GPDMA_CONFIG_E;
   while ((LPC17xx_GPDMA->DMACConfig & GPDMA_CONFIG_E) == 0U);
 
-  Channel_info[ch].Size = size;
-  if (size > 0x0FFFU) {
-    // Max DMA transfer size = 4k
-    size = 0x0FFFU;
+  // Whole list is loaded, nothing is re-armed from the interrupt
+  Channel_info[ch].Size     = (uint32_t)size;
+  Channel_info[ch].Cnt      = Channel_info[ch].Size;
+  Channel_info[ch].Control  = lli->Control;
+  Channel_info[ch].Half     = 0U;
+
+  // First item goes straight to the channel registers
+  dma_ch->SRCADDR  = lli->SrcAddr;
+  dma_ch->DESTADDR = lli->DestAddr;
+  dma_ch->LLI      = lli->Next;
+  dma_ch->CONTROL  = lli->Control;
+  dma_ch->CONFIG   = config;
+
+  if ((config & GPDMA_CONFIG_E) == 0U) {
+    // Clear Channel active flag
+    Clear_Channel_active_flag (ch);
   }
 
-  control = (control & ~GPDMA_CH_CONTROL_TRANSFERSIZE_MSK) | GPDMA_CH_CONTROL_TRANSFERSIZE(size);
+  return 0;
+}
 
-  // Set Source and destination address
-  dma_ch->SRCADDR  = src_addr;
-  dma_ch->DESTADDR = dest_addr;
+/**
+  \fn          int32_t GPDMA_ChannelConfigureCircular (uint8_t              ch,
+                                                       uint32_t             src_addr,
+                                                       uint32_t             dest_addr,
+                                                       uint32_t             size,
+                                                       uint32_t             control,
+                                                       uint32_t             config,
+                                                       GPDMA_SignalEvent_t  cb_event)
+  \brief       Configure GPDMA channel for continuous circular transfer
+  \param[in]   ch        Channel number (0..7)
+  \param[in]   src_addr  Source address
+  \param[in]   dest_addr Destination address
+  \param[in]   size      Amount of data in the buffer, even and at most
+                         GPDMA_CHANNEL_LLI_NUM * 4k
+  \param[in]   control   Channel control
+  \param[in]   config    Channel configuration
+  \param[in]   cb_event  Channel callback pointer
+  \returns
+   - \b  0: function succeeded
+   - \b -1: function failed
+*/
+int32_t GPDMA_ChannelConfigureCircular (uint8_t              ch,
+                                        uint32_t             src_addr,
+                                        uint32_t             dest_addr,
+                                        uint32_t             size,
+                                        uint32_t             control,
+                                        uint32_t             config,
+                                        GPDMA_SignalEvent_t  cb_event) {
+  GPDMA_CHANNEL_REG * dma_ch;
+  GPDMA_LLI         * lli;
+  uint32_t half, num;
+
+  // Check if channel is valid
+  if (ch >= GPDMA_NUMBER_OF_CHANNELS)       { return -1; }
+
+  // Both halves must fit into the channel link list
+  half = size / 2U;
+  num  = GPDMA_LLI_NUM(half);
+  if ((half == 0U) || (size & 1U))          { return -1; }
+  if ((num * 2U) > GPDMA_CHANNEL_LLI_NUM)   { return -1; }
+
+  // Set Channel active flag
+  if (Set_Channel_active_flag (ch) == -1)   { return -1; }
+
+  // Save callback pointer
+  Channel_info[ch].cb_event = cb_event;
+
+  dma_ch = GPDMA_CHANNEL(ch);
+
+  // Reset DMA Channel configuration
+  dma_ch->CONFIG  = 0U;
+  dma_ch->CONTROL = 0U;
+
+  // Clear DMA interrupts
+  LPC17xx_GPDMA->DMACIntTCClear = (1U << ch);
+  LPC17xx_GPDMA->DMACIntErrClr  = (1U << ch);
+
+  // Enable DMA Channels, little endian
+  LPC17xx_GPDMA->DMACConfig = GPDMA_CONFIG_E;
+  while ((LPC17xx_GPDMA->DMACConfig & GPDMA_CONFIG_E) == 0U);
+
+  // One list per half, each ends with terminal count interrupt
+  lli     = Channel_lli[ch];
+  control = control | GPDMA_CH_CONTROL_I;
+  GPDMA_ChainBuild (lli, num, src_addr, dest_addr, half, control);
 
   if (control & GPDMA_CH_CONTROL_SI) {
     // Source address increment
-    src_addr += (size << ((control & GPDMA_CH_CONTROL_SWIDTH_MSK) >> GPDMA_CH_CONTROL_SWIDTH_POS));
+    src_addr  += (half << ((control & GPDMA_CH_CONTROL_SWIDTH_MSK) >> GPDMA_CH_CONTROL_SWIDTH_POS));
   }
   if (control & GPDMA_CH_CONTROL_DI) {
     // Destination address increment
-    dest_addr += (size << ((control & GPDMA_CH_CONTROL_DWIDTH_MSK) >> GPDMA_CH_CONTROL_DWIDTH_POS));
+    dest_addr += (half << ((control & GPDMA_CH_CONTROL_DWIDTH_MSK) >> GPDMA_CH_CONTROL_DWIDTH_POS));
   }
+  GPDMA_ChainBuild (&lli[num], num, src_addr, dest_addr, half, control);
 
-  // Save channel information
-  Channel_info[ch].SrcAddr  = src_addr;
-  Channel_info[ch].DestAddr = dest_addr;
+  // Close the ring
+  lli[num - 1U].Next        = (uint32_t)&lli[num];
+  lli[(num * 2U) - 1U].Next = (uint32_t)&lli[0];
+
+  // Ring is never re-armed from the interrupt
+  Channel_info[ch].Size     = size;
   Channel_info[ch].Cnt      = size;
+  Channel_info[ch].Control  = control;
+  Channel_info[ch].Half     = num;
 
-  dma_ch->CONTROL = control;
-  dma_ch->CONFIG  = config;
+  // First item goes straight to the channel registers
+  dma_ch->SRCADDR  = lli->SrcAddr;
+  dma_ch->DESTADDR = lli->DestAddr;
+  dma_ch->LLI      = lli->Next;
+  dma_ch->CONTROL  = lli->Control;
+  dma_ch->CONFIG   = config;
 
   if ((config & GPDMA_CONFIG_E) == 0U) {
     // Clear Channel active flag
@@ -370,10 +833,62 @@ uint32_t GPDMA_ChannelGetStatus (uint8_t ch) {
   \returns     Number of transferred data
 */
 uint32_t GPDMA_ChannelGetCount (uint8_t ch) {
+  GPDMA_CHANNEL_REG * dma_ch;
+  uint32_t lli, left, cnt, item, i;
+  int32_t  rest;
+
   // Check if channel is valid
   if (ch >= GPDMA_NUMBER_OF_CHANNELS) return 0;
 
-  return (Channel_info[ch].Cnt - (GPDMA_CHANNEL(ch)->CONTROL & GPDMA_CH_CONTROL_TRANSFERSIZE_MSK));
+  dma_ch = GPDMA_CHANNEL(ch);
+
+  if (Channel_info[ch].Half != 0U) {
+    // Circular transfer, position in the buffer
+    do {
+      lli  = dma_ch->LLI;
+      item = Circular_Item (ch);
+      cnt  = (Channel_lli[ch][item].Control & GPDMA_CH_CONTROL_TRANSFERSIZE_MSK) -
+             (dma_ch->CONTROL               & GPDMA_CH_CONTROL_TRANSFERSIZE_MSK);
+      for (i = 0U; i < item; i++) {
+        cnt += Channel_lli[ch][i].Control & GPDMA_CH_CONTROL_TRANSFERSIZE_MSK;
+      }
+    } while (lli != dma_ch->LLI);
+
+    return cnt;
+  }
+
+  // Items not yet loaded are still to transfer, retry if the channel
+  // moved to the next item in between
+  do {
+    lli  = dma_ch->LLI;
+    rest = Chain_Size ((const GPDMA_LLI *)lli);
+    if (rest < 0) { return 0U; }
+    left = (dma_ch->CONTROL & GPDMA_CH_CONTROL_TRANSFERSIZE_MSK) + (uint32_t)rest;
+  } while (lli != dma_ch->LLI);
+
+  return (Channel_info[ch].Cnt - left);
+}
+
+/**
+  \fn          uint32_t GPDMA_ChannelGetLatency (uint8_t ch, uint32_t *max)
+  \brief       Get interrupt entry to callback latency (GPDMA_IRQ_LATENCY)
+  \param[in]   ch  Channel number (0..7)
+  \param[out]  max Highest latency seen
+  \returns     Latency of the last callback in DWT cycles, 0 when not recorded
+*/
+uint32_t GPDMA_ChannelGetLatency (uint8_t ch, uint32_t *max) {
+
+  *max = 0U;
+
+  // Check if channel is valid
+  if (ch >= GPDMA_NUMBER_OF_CHANNELS) { return 0U; }
+
+#if (GPDMA_IRQ_LATENCY != 0U)
+  *max = Channel_latency[ch].Max;
+  return Channel_latency[ch].Last;
+#else
+  return 0U;
+#endif
 }
 
 /**
@@ -381,72 +896,62 @@ uint32_t GPDMA_ChannelGetCount (uint8_t ch) {
   \brief       DMA interrupt handler
 */
 void DMA_IRQHandler (void) {
-  uint32_t ch, size;
+  uint32_t ch, tc, err, pending, entry;
   GPDMA_CHANNEL_REG * dma_ch;
 
-  for (ch = 0U; ch < GPDMA_NUMBER_OF_CHANNELS; ch++) {
-    if (LPC17xx_GPDMA->DMACIntStat & (1U << ch)) {
-      dma_ch = GPDMA_CHANNEL(ch);
-
-      // Terminal count request interrupt
-      if (LPC17xx_GPDMA->DMACIntTCStat & (1U << ch)) {
-        // Clear interrupt flag
-        LPC17xx_GPDMA->DMACIntTCClear = (1U << ch);
-
-        if (Channel_info[ch].Cnt != Channel_info[ch].Size) {
-          // Data waiting to transfer
-
-          size = Channel_info[ch].Size - Channel_info[ch].Cnt;
-          // Max DMA transfer size = 4k
-          if (size > 0x0FFFU) { size = 0x0FFFU; }
-
-          Channel_info[ch].Cnt += size;
-
-          if (dma_ch->CONTROL & GPDMA_CH_CONTROL_SI) {
-            // Source Address Increment
-            dma_ch->SRCADDR = Channel_info[ch].SrcAddr;
-            Channel_info[ch].SrcAddr += (size << ((dma_ch->CONTROL & GPDMA_CH_CONTROL_SWIDTH_MSK) >> GPDMA_CH_CONTROL_SWIDTH_POS));
-          }
-          if (dma_ch->CONTROL & GPDMA_CH_CONTROL_DI) {
-            // Destination address increment
-            dma_ch->DESTADDR = Channel_info[ch].DestAddr;
-            Channel_info[ch].DestAddr += (size << ((dma_ch->CONTROL & GPDMA_CH_CONTROL_DWIDTH_MSK) >> GPDMA_CH_CONTROL_DWIDTH_POS));
-          }
-
-          // Set transfer size
-          dma_ch->CONTROL = (dma_ch->CONTROL & ~GPDMA_CH_CONTROL_TRANSFERSIZE_MSK) | GPDMA_CH_CONTROL_TRANSFERSIZE(size);
-
-          // Enable DMA Channel
-          dma_ch->CONFIG |= GPDMA_CH_CONFIG_E;
-        } else {
-          // All Data has been transferred
-
-          // Clear Channel active flag
-          Clear_Channel_active_flag ((uint8_t)ch);
-
-          // Signal Event
-          if (Channel_info[ch].cb_event) {
-            Channel_info[ch].cb_event(GPDMA_EVENT_TERMINAL_COUNT_REQUEST);
-          }
-        }
+#if (GPDMA_IRQ_LATENCY != 0U)
+  entry = DWT->CYCCNT;
+#else
+  entry = 0U;
+#endif
+
+  // Snapshot status once, terminal count takes precedence over an error
+  // on the same channel, the error stays pending for the next entry
+  tc  = LPC17xx_GPDMA->DMACIntTCStat;
+  err = LPC17xx_GPDMA->DMACIntErrStat & ~tc;
+  LPC17xx_GPDMA->DMACIntTCClear = tc;
+
+  // Lowest channel number (highest priority) first
+  pending = tc | err;
+  while (pending != 0U) {
+    ch       = __CLZ (__RBIT (pending));
+    pending &= ~(1U << ch);
+    dma_ch   = GPDMA_CHANNEL(ch);
+
+    // Terminal count request interrupt
+    if (tc & (1U << ch)) {
+      if (Channel_info[ch].Half != 0U) {
+        // Circular transfer, the half before the running item is done
+        Signal_Event (ch, (Circular_Item ((uint8_t)ch) < Channel_info[ch].Half) ?
+                          GPDMA_EVENT_TERMINAL_COUNT_REQUEST : GPDMA_EVENT_HALF_TRANSFER, entry);
+      } else if (Channel_info[ch].Cnt != Channel_info[ch].Size) {
+        // Data waiting to transfer, bigger than the channel link list
+        Channel_Load ((uint8_t)ch);
+
+        // Enable DMA Channel
+        dma_ch->CONFIG |= GPDMA_CH_CONFIG_E;
       } else {
-        // DMA error interrupt
-        if (LPC17xx_GPDMA->DMACIntErrStat & (1U << ch)) {
-          dma_ch->CONFIG  = 0U;
-          dma_ch->CONTROL = 0U;
-
-          // Clear Channel active flag
-          Clear_Channel_active_flag ((uint8_t)ch);
-
-          // Clear interrupt flag
-          LPC17xx_GPDMA->DMACIntErrClr = (1U << ch);
-
-          // Signal Event
-          if (Channel_info[ch].cb_event) {
-            Channel_info[ch].cb_event(GPDMA_EVENT_ERROR);
-          }
-        }
+        // All Data has been transferred
+
+        // Clear Channel active flag
+        Clear_Channel_active_flag ((uint8_t)ch);
+
+        // Signal Event
+        Signal_Event (ch, GPDMA_EVENT_TERMINAL_COUNT_REQUEST, entry);
       }
+    } else {
+      // DMA error interrupt
+      dma_ch->CONFIG  = 0U;
+      dma_ch->CONTROL = 0U;
+
+      // Clear Channel active flag
+      Clear_Channel_active_flag ((uint8_t)ch);
+
+      // Clear interrupt flag
+      LPC17xx_GPDMA->DMACIntErrClr = (1U << ch);
+
+      // Signal Event
+      Signal_Event (ch, GPDMA_EVENT_ERROR, entry);
     }
   }
 }
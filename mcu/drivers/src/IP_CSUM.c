@@ -0,0 +1,304 @@
+/* --------------------------------------------------------------------------
+ * $Date:        17. October 2026
+ * $Revision:    V1.1
+ *
+ * Project:      Internet Checksum (RFC 1071) for Cortex-M3
+ * -------------------------------------------------------------------------- */
+
+#include "IP_CSUM.h"
+
+/* Frame fields used by the frame checksums */
+#define ETH_HDR_LEN         14U         /* Ethernet header length             */
+#define IP4_HDR_MIN         20U         /* IPv4 header length without options */
+#define IP_PROTO_ICMP       1U
+#define IP_PROTO_TCP        6U
+#define IP_PROTO_UDP        17U
+
+/* Words are summed into a 64-bit accumulator, which compiles to ADDS/ADC
+   pairs. The carries collected in the upper half are folded back once at
+   the end. Cortex-M3 handles unaligned LDR/STR, so no alignment pass is
+   needed. The last odd byte is the low byte of its 16-bit word, this is
+   little-endian only. */
+
+/**
+  \fn          uint32_t fold64 (uint64_t acc)
+  \brief       Fold a 64-bit accumulator to a 32-bit partial sum.
+*/
+__STATIC_INLINE uint32_t fold64 (uint64_t acc) {
+  return (IP_CSUM_Merge ((uint32_t)acc, (uint32_t)(acc >> 32)));
+}
+
+/**
+  \fn          uint32_t IP_CSUM_Add (uint32_t sum, const void *data, uint32_t len)
+  \brief       Add data to a partial Internet checksum.
+  \param[in]   sum   Partial sum of the preceding data, 0 for the first block
+  \param[in]   data  Pointer to buffer containing the data, any alignment
+  \param[in]   len   Data length in bytes
+  \returns     partial sum
+*/
+uint32_t IP_CSUM_Add (uint32_t sum, const void *data, uint32_t len) {
+  const uint8_t *p = (const uint8_t *)data;
+  uint64_t acc = sum;
+
+  /* 16 bytes per step */
+  for ( ; len > 15U; p += 16U, len -= 16U) {
+    acc += __UNALIGNED_UINT32_READ(&p[0]);
+    acc += __UNALIGNED_UINT32_READ(&p[4]);
+    acc += __UNALIGNED_UINT32_READ(&p[8]);
+    acc += __UNALIGNED_UINT32_READ(&p[12]);
+  }
+  for ( ; len > 3U; p += 4U, len -= 4U) {
+    acc += __UNALIGNED_UINT32_READ(&p[0]);
+  }
+  /* Remaining 3 bytes */
+  if (len > 1U) {
+    acc += __UNALIGNED_UINT16_READ(&p[0]);
+    p   += 2U;
+    len -= 2U;
+  }
+  if (len > 0U) {
+    acc += p[0];
+  }
+
+  return (fold64 (acc));
+}
+
+/**
+  \fn          uint32_t IP_CSUM_Copy (uint32_t sum, void *dst, const void *src, uint32_t len)
+  \brief       Copy data and add it to a partial Internet checksum in the same pass.
+  \param[in]   sum   Partial sum of the preceding data, 0 for the first block
+  \param[out]  dst   Pointer to destination buffer, any alignment
+  \param[in]   src   Pointer to source buffer, any alignment
+  \param[in]   len   Data length in bytes
+  \returns     partial sum
+*/
+uint32_t IP_CSUM_Copy (uint32_t sum, void *dst, const void *src, uint32_t len) {
+  const uint8_t *s = (const uint8_t *)src;
+  uint8_t *d = (uint8_t *)dst;
+  uint64_t acc = sum;
+  uint32_t w0, w1, w2, w3;
+
+  /* 16 bytes per step, loads grouped ahead of the stores */
+  for ( ; len > 15U; s += 16U, d += 16U, len -= 16U) {
+    w0 = __UNALIGNED_UINT32_READ(&s[0]);
+    w1 = __UNALIGNED_UINT32_READ(&s[4]);
+    w2 = __UNALIGNED_UINT32_READ(&s[8]);
+    w3 = __UNALIGNED_UINT32_READ(&s[12]);
+    __UNALIGNED_UINT32_WRITE(&d[0],  w0);
+    __UNALIGNED_UINT32_WRITE(&d[4],  w1);
+    __UNALIGNED_UINT32_WRITE(&d[8],  w2);
+    __UNALIGNED_UINT32_WRITE(&d[12], w3);
+    acc += w0;
+    acc += w1;
+    acc += w2;
+    acc += w3;
+  }
+  for ( ; len > 3U; s += 4U, d += 4U, len -= 4U) {
+    w0 = __UNALIGNED_UINT32_READ(&s[0]);
+    __UNALIGNED_UINT32_WRITE(&d[0], w0);
+    acc += w0;
+  }
+  /* Remaining 3 bytes */
+  if (len > 1U) {
+    w0 = __UNALIGNED_UINT16_READ(&s[0]);
+    __UNALIGNED_UINT16_WRITE(&d[0], (uint16_t)w0);
+    acc += w0;
+    s   += 2U;
+    d   += 2U;
+    len -= 2U;
+  }
+  if (len > 0U) {
+    d[0] = s[0];
+    acc += s[0];
+  }
+
+  return (fold64 (acc));
+}
+
+/**
+  \fn          uint32_t csum_ip4_end (const uint8_t *frame, uint32_t size, uint32_t len)
+  \brief       Check for an IPv4 frame with consistent header lengths.
+  \param[in]   frame  Frame data
+  \param[in]   size   Bytes at frame, the IPv4 header must be within them
+  \param[in]   len    Frame length in bytes
+  \return      offset of the IPv4 datagram end, 0 for other frames.
+*/
+static uint32_t csum_ip4_end (const uint8_t *frame, uint32_t size, uint32_t len) {
+  const uint8_t *ip = &frame[ETH_HDR_LEN];
+  uint32_t hlen, end;
+
+  if ((size < (ETH_HDR_LEN + IP4_HDR_MIN)) ||
+      (frame[12] != 0x08U) || (frame[13] != 0x00U) || ((ip[0] >> 4) != 4U)) {
+    return (0U);
+  }
+
+  hlen = (ip[0] & 0x0FU) << 2;
+  end  = ETH_HDR_LEN + (((uint32_t)ip[2] << 8) | ip[3]);
+  if ((hlen < IP4_HDR_MIN) || ((ETH_HDR_LEN + hlen) > size) ||
+      (end < (ETH_HDR_LEN + hlen)) || (end > len)) {
+    return (0U);
+  }
+  return (end);
+}
+
+/**
+  \fn          uint32_t csum_field (const uint8_t *frame, uint32_t end)
+  \brief       Find the ICMP/UDP/TCP checksum field of an IPv4 frame.
+  \param[in]   frame  IPv4 frame data
+  \param[in]   end    Offset of the IPv4 datagram end
+  \return      offset of the checksum field, 0 when there is none to do.
+*/
+static uint32_t csum_field (const uint8_t *frame, uint32_t end) {
+  const uint8_t *ip = &frame[ETH_HDR_LEN];
+  uint32_t l4, off;
+
+  if ((ip[6] & 0x3FU) || ip[7]) {
+    /* IP fragment, the checksum covers the whole datagram */
+    return (0U);
+  }
+
+  switch (ip[9]) {
+    case IP_PROTO_ICMP: off = 2U;  break;
+    case IP_PROTO_TCP:  off = 16U; break;
+    case IP_PROTO_UDP:  off = 6U;  break;
+    default:            return (0U);
+  }
+  l4 = ETH_HDR_LEN + ((ip[0] & 0x0FU) << 2);
+  if ((l4 + off + 2U) > end) {
+    return (0U);
+  }
+  return (l4 + off);
+}
+
+/**
+  \fn          uint32_t csum_payload (const uint8_t *frame, uint32_t len, uint32_t end,
+                                     uint32_t sum, uint32_t *field)
+  \brief       Get the ICMP/UDP/TCP checksum sum out of the whole frame sum.
+  \param[in]   frame  IPv4 frame data
+  \param[in]   len    Frame length in bytes
+  \param[in]   end    Offset of the IPv4 datagram end
+  \param[in]   sum    Partial sum of the whole frame
+  \param[out]  field  Offset of the checksum field, 0 when there is none to do
+  \return      partial sum of the payload and pseudo header, checksum field left out.
+*/
+static uint32_t csum_payload (const uint8_t *frame, uint32_t len, uint32_t end,
+                              uint32_t sum, uint32_t *field) {
+  const uint8_t *ip = &frame[ETH_HDR_LEN];
+  uint32_t l4, hdr;
+  uint8_t  pseudo[4];
+
+  *field = csum_field (frame, end);
+  if (*field == 0U) {
+    return (0U);
+  }
+  l4 = ETH_HDR_LEN + ((ip[0] & 0x0FU) << 2);
+
+  /* Take the headers in front and the padding behind out of the frame sum,
+     ~x subtracts x in one's complement. The padding may start odd. */
+  sum = IP_CSUM_Merge (sum, ~IP_CSUM_Add (0U, frame, l4));
+  hdr = IP_CSUM_Add (0U, &frame[end], len - end);
+  sum = IP_CSUM_Merge (sum, ~((end & 1U) ? IP_CSUM_Swap (hdr) : hdr));
+  sum = IP_CSUM_Merge (sum, ~(uint32_t)__UNALIGNED_UINT16_READ(&frame[*field]));
+
+  if (ip[9] != IP_PROTO_ICMP) {
+    /* Pseudo header: addresses, protocol and payload length */
+    pseudo[0] = 0U;
+    pseudo[1] = ip[9];
+    pseudo[2] = (uint8_t)((end - l4) >> 8);
+    pseudo[3] = (uint8_t) (end - l4);
+    sum = IP_CSUM_Merge (sum, IP_CSUM_Add (IP_CSUM_Add (0U, &ip[12], 8U), pseudo, 4U));
+  }
+
+  return (sum);
+}
+
+/**
+  \fn          void IP_CSUM_FrameInsert (uint8_t *frame, uint32_t len, uint32_t sum)
+  \brief       Fill in IPv4 and ICMP/UDP/TCP checksums of a frame to send.
+  \param[in]   frame  Frame data
+  \param[in]   len    Frame length in bytes
+  \param[in]   sum    Partial sum of the whole frame with the checksum fields as they are
+  \return      none.
+*/
+void IP_CSUM_FrameInsert (uint8_t *frame, uint32_t len, uint32_t sum) {
+  uint8_t *ip = &frame[ETH_HDR_LEN];
+  uint32_t end, field;
+
+  end = csum_ip4_end (frame, len, len);
+  if (end == 0U) {
+    return;
+  }
+
+  /* Payload first, the frame sum covers the IPv4 header as it was */
+  sum = csum_payload (frame, len, end, sum, &field);
+  if (field != 0U) {
+    sum = ~IP_CSUM_Fold (sum) & 0xFFFFU;
+    if ((sum == 0U) && (ip[9] == IP_PROTO_UDP)) {
+      /* Zero is "no checksum" for UDP */
+      sum = 0xFFFFU;
+    }
+    __UNALIGNED_UINT16_WRITE(&frame[field], (uint16_t)sum);
+  }
+
+  __UNALIGNED_UINT16_WRITE(&ip[10], 0U);
+  sum = IP_CSUM_Add (0U, ip, (ip[0] & 0x0FU) << 2);
+  __UNALIGNED_UINT16_WRITE(&ip[10], (uint16_t)~IP_CSUM_Fold (sum));
+}
+
+/**
+  \fn          bool IP_CSUM_FrameCheck (const uint8_t *frame, uint32_t len, uint32_t sum)
+  \brief       Verify IPv4 and ICMP/UDP/TCP checksums of a received frame.
+  \param[in]   frame  Frame data
+  \param[in]   len    Frame length in bytes
+  \param[in]   sum    Partial sum of the whole frame
+  \return      false when a checksum is wrong, true otherwise.
+*/
+bool IP_CSUM_FrameCheck (const uint8_t *frame, uint32_t len, uint32_t sum) {
+  const uint8_t *ip = &frame[ETH_HDR_LEN];
+  uint32_t end, field, val;
+
+  end = csum_ip4_end (frame, len, len);
+  if (end == 0U) {
+    /* Not IPv4, or left for the stack to reject */
+    return (true);
+  }
+
+  if (IP_CSUM_Fold (IP_CSUM_Add (0U, ip, (ip[0] & 0x0FU) << 2)) != 0xFFFFU) {
+    return (false);
+  }
+
+  sum = csum_payload (frame, len, end, sum, &field);
+  if (field == 0U) {
+    return (true);
+  }
+  val = __UNALIGNED_UINT16_READ(&frame[field]);
+  if ((val == 0U) && (ip[9] == IP_PROTO_UDP)) {
+    /* UDP sent without checksum */
+    return (true);
+  }
+  return (IP_CSUM_Fold (IP_CSUM_Merge (sum, val)) == 0xFFFFU);
+}
+
+/**
+  \fn          uint32_t IP_CSUM_FrameEnd (const uint8_t *frame, uint32_t size, uint32_t len)
+  \brief       Get the IPv4 datagram end of a frame only partly contiguous.
+  \param[in]   frame  Frame data
+  \param[in]   size   Bytes at frame
+  \param[in]   len    Frame length in bytes
+  \return      offset of the IPv4 datagram end, 0 for other frames or when the
+               headers up to the checksum field are not within size.
+*/
+uint32_t IP_CSUM_FrameEnd (const uint8_t *frame, uint32_t size, uint32_t len) {
+  uint32_t end, field;
+
+  end = csum_ip4_end (frame, size, len);
+  if (end == 0U) {
+    return (0U);
+  }
+
+  field = csum_field (frame, end);
+  if ((field != 0U) && ((field + 2U) > size)) {
+    return (0U);
+  }
+  return (end);
+}
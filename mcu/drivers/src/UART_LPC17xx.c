@@ -18,7 +18,7 @@
  *
  *
  * $Date:        15. Januar 2020
- * $Revision:    V2.13
+ * $Revision:    V2.18
  *
  * Driver:       Driver_USART0, Driver_USART1, Driver_USART2, Driver_USART3,
  *               Driver_USART4
@@ -38,6 +38,18 @@
  * -------------------------------------------------------------------------- */
 
 /* History:
+ *  Version 2.18
+ *    - Fractional divider search starts at a divider of 48 (LPC175x_6x)
+ *  Version 2.17
+ *    - Added optional interrupt cycle accounting (USART_IRQ_CYCLES)
+ *  Version 2.16
+ *    - GPDMA error events release the DMA channel and end the transfer
+ *  Version 2.15
+ *    - DMA channels can be taken from the GPDMA channel pool per transfer
+ *  Version 2.14
+ *    - Baudrate dividers below the fractional divider limit fall back to
+ *      the nearest integer latch divider (LPC175x_6x)
+ *    - Baudrate error check no longer truncates the error percentage
  *  Version 2.13
  *    - Corrected USART4_Resources (RTE_UART4_DMA_RX_EN)
  *  Version 2.12
@@ -88,7 +100,7 @@
 #include "RTE_Device.h"
 #include "RTE_Components.h"
 
-#define ARM_USART_DRV_VERSION ARM_DRIVER_VERSION_MAJOR_MINOR(2,13)
+#define ARM_USART_DRV_VERSION ARM_DRIVER_VERSION_MAJOR_MINOR(2,18)
 
 #if ((defined(RTE_Drivers_USART0) || \
       defined(RTE_Drivers_USART1) || \
@@ -1137,7 +1149,7 @@ int32_t USART_SetBaudrate (uint32_t         baudrate,
 #if defined (LPC177x_8x)
       oversampling_best = 16U;
 #endif
-    } else if (div >= FIXED_OVERSAMPLING_DIVIDER_LIMIT) {
+    } else if (div >= FRACT_DIVIDER_LIMIT) {
  
       // Divider larger than 48, can be accomplished with configurable
       // latch and fractional divider, and fixed oversampling to 16
@@ -1280,7 +1292,16 @@ int32_t USART_SetBaudrate (uint32_t         baudrate,
     }
 #else
     else {
-      return -1;
+      // Divider below the limit: fractional divider requires latch divider
+      // of at least 3, use the nearest integer latch divider instead
+      latch_div = (div + (1U << (FRACT_BITS + 3U))) >> (FRACT_BITS + 4U);
+      if (latch_div == 0U) { return -1; }
+
+      tmp_div = latch_div << (FRACT_BITS + 4U);
+      if (div > tmp_div) { delta_best = div - tmp_div; }
+      else               { delta_best = tmp_div - div; }
+      add_mul_best      = 0U;
+      latch_div_best    = latch_div & 0xFFFFU;
     }
 #endif
 
@@ -1288,7 +1309,7 @@ int32_t USART_SetBaudrate (uint32_t         baudrate,
   }
 #endif
 
-  if (((delta_best * 100U) / div) > USART_MAX_BAUDRATE_ERROR) { return -1; }
+  if (((uint64_t)delta_best * 100U) > ((uint64_t)div * USART_MAX_BAUDRATE_ERROR)) { return -1; }
 
   usart->reg->LCR |= USART_LCR_DLAB;
   usart->reg->DLM  = (uint8_t)(((latch_div_best >> 8) & 0xFFU) << USART_DLM_DLMSB_POS);
@@ -1358,6 +1379,16 @@ static uint32_t USART_RxLineIntHandler (USART_RESOURCES *usart) {
   return event;
 }
 
+/**
+  \fn          void USART_DMA_Release (USART_DMA *dma, uint8_t ch)
+  \brief       Return DMA channel taken from the GPDMA channel pool
+  \param[in]   dma       Pointer to USART DMA resources
+  \param[in]   ch        DMA Channel number in use
+*/
+__inline static void USART_DMA_Release (USART_DMA *dma, uint8_t ch) {
+  if (GPDMA_CHANNEL_IS_POOL(dma->channel)) { GPDMA_ChannelRelease (ch); }
+}
+
 /**
   \fn          void USART_PIN_Configure (USART_RESOURCES  *usart)
   \brief       Configure USART Rx and TX pin
@@ -1547,6 +1578,10 @@ static int32_t USART_Initialize (ARM_USART_SignalEvent_t  cb_event,
   // DMA Initialize
   if (usart->dma_tx || usart->dma_rx) { GPDMA_Initialize (); }
 
+  // Fixed DMA channels, pool channels are taken per transfer
+  if (usart->dma_tx) { usart->info->tx_dma_ch = usart->dma_tx->channel; }
+  if (usart->dma_rx) { usart->info->rx_dma_ch = usart->dma_rx->channel; }
+
   usart->info->flags = USART_FLAG_INITIALIZED;
 
   return ARM_DRIVER_OK;
@@ -1701,12 +1736,16 @@ static int32_t USART_PowerControl (ARM_POWER_STATE  state,
 
       // If DMA mode - disable TX DMA channel
       if ((usart->dma_tx) && (usart->info->xfer.send_active != 0U)) {
-        GPDMA_ChannelDisable (usart->dma_tx->channel);
+        usart->info->xfer.tx_cnt = GPDMA_ChannelGetCount (usart->info->tx_dma_ch);
+        GPDMA_ChannelDisable (usart->info->tx_dma_ch);
+        USART_DMA_Release (usart->dma_tx, usart->info->tx_dma_ch);
       }
 
       // If DMA mode - disable DMA channel
       if ((usart->dma_rx) && (usart->info->rx_status.rx_busy)) {
-        GPDMA_ChannelDisable (usart->dma_rx->channel);
+        usart->info->xfer.rx_cnt = GPDMA_ChannelGetCount (usart->info->rx_dma_ch);
+        GPDMA_ChannelDisable (usart->info->rx_dma_ch);
+        USART_DMA_Release (usart->dma_rx, usart->info->rx_dma_ch);
       }
 
       // Disable power to UART block
@@ -1810,6 +1849,7 @@ static int32_t USART_Send (const void            *data,
                                  USART_RESOURCES *usart) {
   int32_t  stat;
   uint32_t source_inc, event;
+  uint8_t  ch;
 
   if ((data == NULL) || (num == 0U)) {
     // Invalid parameters
@@ -1857,11 +1897,23 @@ static int32_t USART_Send (const void            *data,
   // DMA mode
   if (usart->dma_tx) {
 
+    // Take DMA channel from the channel pool
+    ch = usart->dma_tx->channel;
+    if (GPDMA_CHANNEL_IS_POOL(ch)) {
+      stat = GPDMA_ChannelAllocate (GPDMA_CHANNEL_PRIO(ch));
+      if (stat == -1) {
+        usart->info->xfer.send_active = 0U;
+        return ARM_DRIVER_ERROR_BUSY;
+      }
+      ch = (uint8_t)stat;
+    }
+    usart->info->tx_dma_ch = ch;
+
     // Configure DMA mux
     GPDMA_PeripheralSelect (usart->dma_tx->request, usart->dma_tx->select);
 
     // Configure DMA channel
-    stat = GPDMA_ChannelConfigure (usart->dma_tx->channel,
+    stat = GPDMA_ChannelConfigure (ch,
                                    (uint32_t)data,
                                    (uint32_t)(&(usart->reg->THR)),
                                    num,
@@ -1877,7 +1929,10 @@ static int32_t USART_Send (const void            *data,
                                    GPDMA_CH_CONFIG_ITC                                      |
                                    GPDMA_CH_CONFIG_E,
                                    usart->dma_tx->cb_event);
-  if (stat == -1) { return ARM_DRIVER_ERROR; }
+  if (stat == -1) {
+    USART_DMA_Release (usart->dma_tx, ch);
+    return ARM_DRIVER_ERROR;
+  }
 
   // Interrupt mode
   } else {
@@ -1934,6 +1989,7 @@ static int32_t USART_Receive (void            *data,
 
   int32_t  stat;
   uint32_t dest_inc;
+  uint8_t  ch;
 
   if ((data == NULL) || (num == 0U)) {
     // Invalid parameters
@@ -1979,10 +2035,22 @@ static int32_t USART_Receive (void            *data,
 
   // DMA mode
   if (usart->dma_rx) {
+    // Take DMA channel from the channel pool
+    ch = usart->dma_rx->channel;
+    if (GPDMA_CHANNEL_IS_POOL(ch)) {
+      stat = GPDMA_ChannelAllocate (GPDMA_CHANNEL_PRIO(ch));
+      if (stat == -1) {
+        usart->info->rx_status.rx_busy = 0U;
+        return ARM_DRIVER_ERROR_BUSY;
+      }
+      ch = (uint8_t)stat;
+    }
+    usart->info->rx_dma_ch = ch;
+
     // Configure DMA mux
     GPDMA_PeripheralSelect (usart->dma_rx->request, usart->dma_rx->select);
 
-    stat = GPDMA_ChannelConfigure (usart->dma_rx->channel,
+    stat = GPDMA_ChannelConfigure (ch,
                                    (uint32_t)&usart->reg->RBR,
                                    (uint32_t)data,
                                    num,
@@ -1998,7 +2066,10 @@ static int32_t USART_Receive (void            *data,
                                    GPDMA_CH_CONFIG_ITC                                      |
                                    GPDMA_CH_CONFIG_E,
                                    usart->dma_rx->cb_event);
-  if (stat == -1) { return ARM_DRIVER_ERROR; }
+  if (stat == -1) {
+    USART_DMA_Release (usart->dma_rx, ch);
+    return ARM_DRIVER_ERROR;
+  }
 
   // Interrupt mode
   } else {
@@ -2078,8 +2149,8 @@ static int32_t USART_Transfer (const void             *data_out,
 static uint32_t USART_GetTxCount (USART_RESOURCES *usart) {
   uint32_t cnt;
 
-  if (usart->dma_tx) {
-    cnt = GPDMA_ChannelGetCount (usart->dma_tx->channel);
+  if ((usart->dma_tx) && (usart->info->xfer.send_active != 0U)) {
+    cnt = GPDMA_ChannelGetCount (usart->info->tx_dma_ch);
   } else {
     cnt = usart->info->xfer.tx_cnt;
   }
@@ -2096,8 +2167,8 @@ static uint32_t USART_GetTxCount (USART_RESOURCES *usart) {
 static uint32_t USART_GetRxCount (USART_RESOURCES *usart) {
   uint32_t cnt;
 
-  if (usart->dma_rx) {
-    cnt = GPDMA_ChannelGetCount (usart->dma_rx->channel);
+  if ((usart->dma_rx) && (usart->info->rx_status.rx_busy)) {
+    cnt = GPDMA_ChannelGetCount (usart->info->rx_dma_ch);
   } else {
     cnt = usart->info->xfer.rx_cnt;
   }
@@ -2211,7 +2282,9 @@ static int32_t USART_Control (uint32_t          control,
 
       // If DMA mode - disable DMA channel
       if ((usart->dma_tx) && (usart->info->xfer.send_active != 0U)) {
-        GPDMA_ChannelDisable (usart->dma_tx->channel);
+        usart->info->xfer.tx_cnt = GPDMA_ChannelGetCount (usart->info->tx_dma_ch);
+        GPDMA_ChannelDisable (usart->info->tx_dma_ch);
+        USART_DMA_Release (usart->dma_tx, usart->info->tx_dma_ch);
       }
 
       // Clear Send active flag
@@ -2236,7 +2309,9 @@ static int32_t USART_Control (uint32_t          control,
 
       // If DMA mode - disable DMA channel
       if ((usart->dma_rx) && (usart->info->rx_status.rx_busy)) {
-        GPDMA_ChannelDisable (usart->dma_rx->channel);
+        usart->info->xfer.rx_cnt = GPDMA_ChannelGetCount (usart->info->rx_dma_ch);
+        GPDMA_ChannelDisable (usart->info->rx_dma_ch);
+        USART_DMA_Release (usart->dma_rx, usart->info->rx_dma_ch);
       }
 
       // Clear RX busy status
@@ -2251,10 +2326,14 @@ static int32_t USART_Control (uint32_t          control,
 
       // If DMA mode - disable DMA channel
       if ((usart->dma_tx) && (usart->info->xfer.send_active != 0U)) {
-        GPDMA_ChannelDisable (usart->dma_tx->channel);
+        usart->info->xfer.tx_cnt = GPDMA_ChannelGetCount (usart->info->tx_dma_ch);
+        GPDMA_ChannelDisable (usart->info->tx_dma_ch);
+        USART_DMA_Release (usart->dma_tx, usart->info->tx_dma_ch);
       }
       if ((usart->dma_rx) && (usart->info->rx_status.rx_busy)) {
-        GPDMA_ChannelDisable (usart->dma_rx->channel);
+        usart->info->xfer.rx_cnt = GPDMA_ChannelGetCount (usart->info->rx_dma_ch);
+        GPDMA_ChannelDisable (usart->info->rx_dma_ch);
+        USART_DMA_Release (usart->dma_rx, usart->info->rx_dma_ch);
       }
 
       // Set trigger level
@@ -2652,6 +2731,9 @@ static ARM_USART_MODEM_STATUS USART_GetModemStatus (USART_RESOURCES *usart) {
 */
 static void USART_IRQHandler (USART_RESOURCES *usart) {
   uint32_t iir, event, val, i = 0U;
+#if (USART_IRQ_CYCLES != 0U)
+  uint32_t entry = DWT->CYCCNT;
+#endif
 
   event = 0U;
   iir   = usart->reg->IIR;
@@ -2800,6 +2882,9 @@ static void USART_IRQHandler (USART_RESOURCES *usart) {
   if ((usart->info->cb_event != NULL) && (event != 0U)) {
     usart->info->cb_event (event);
   }
+#if (USART_IRQ_CYCLES != 0U)
+  usart->info->irq_cycles += DWT->CYCCNT - entry;
+#endif
 }
 
 #if (((RTE_UART0) && (RTE_UART0_DMA_TX_EN == 1)) || \
@@ -2814,11 +2899,16 @@ static void USART_IRQHandler (USART_RESOURCES *usart) {
   \param[in]   event     GPDMA_EVENT_TERMINAL_COUNT_REQUEST / GPDMA_EVENT_ERROR
 */
 static void USART_GPDMA_Tx_Event (uint32_t event, USART_RESOURCES *usart) {
+#if (USART_IRQ_CYCLES != 0U)
+  uint32_t entry = DWT->CYCCNT;
+#endif
+
   switch (event) {
     case GPDMA_EVENT_TERMINAL_COUNT_REQUEST:
       usart->info->xfer.tx_cnt = usart->info->xfer.tx_num;
       // Clear TX busy flag
       usart->info->xfer.send_active = 0U;
+      USART_DMA_Release (usart->dma_tx, usart->info->tx_dma_ch);
 
       // Set Send Complete event for asynchronous transfers
       if ((usart->info->mode != ARM_USART_MODE_SYNCHRONOUS_MASTER) &&
@@ -2829,9 +2919,16 @@ static void USART_GPDMA_Tx_Event (uint32_t event, USART_RESOURCES *usart) {
       }
       break;
     case GPDMA_EVENT_ERROR:
+      // Channel is already disabled, end the transfer so Send can restart
+      usart->info->xfer.send_active = 0U;
+      USART_DMA_Release (usart->dma_tx, usart->info->tx_dma_ch);
+      break;
     default:
       break;
   }
+#if (USART_IRQ_CYCLES != 0U)
+  usart->info->irq_cycles += DWT->CYCCNT - entry;
+#endif
 }
 #endif
 
@@ -2848,6 +2945,9 @@ static void USART_GPDMA_Tx_Event (uint32_t event, USART_RESOURCES *usart) {
 */
 static void USART_GPDMA_Rx_Event (uint32_t event, USART_RESOURCES *usart) {
   uint32_t val, evt;
+#if (USART_IRQ_CYCLES != 0U)
+  uint32_t entry = DWT->CYCCNT;
+#endif
 
   evt = 0U;
 
@@ -2855,6 +2955,7 @@ static void USART_GPDMA_Rx_Event (uint32_t event, USART_RESOURCES *usart) {
     case GPDMA_EVENT_TERMINAL_COUNT_REQUEST:
       usart->info->xfer.rx_cnt    = usart->info->xfer.rx_num; 
       usart->info->rx_status.rx_busy = 0U;
+      USART_DMA_Release (usart->dma_rx, usart->info->rx_dma_ch);
 
       if ((usart->info->mode == ARM_USART_MODE_SYNCHRONOUS_MASTER) ||
           (usart->info->mode == ARM_USART_MODE_SYNCHRONOUS_SLAVE )) {
@@ -2880,12 +2981,52 @@ static void USART_GPDMA_Rx_Event (uint32_t event, USART_RESOURCES *usart) {
       }
       break;
     case GPDMA_EVENT_ERROR:
+      // Channel is already disabled, end the transfer so Receive can restart
+      usart->info->rx_status.rx_busy = 0U;
+      usart->info->xfer.sync_mode    = 0U;
+      USART_DMA_Release (usart->dma_rx, usart->info->rx_dma_ch);
+      break;
     default:
       break;
   }
+#if (USART_IRQ_CYCLES != 0U)
+  usart->info->irq_cycles += DWT->CYCCNT - entry;
+#endif
 }
 #endif
 
+/**
+  \fn          uint32_t USART_GetIrqCycles (uint8_t uart)
+  \brief       Get cycles spent in the UART interrupt and its GPDMA events
+  \param[in]   uart  UART number (0..4)
+  \returns     Running total of DWT cycles, 0 when not recorded
+*/
+uint32_t USART_GetIrqCycles (uint8_t uart) {
+#if (USART_IRQ_CYCLES != 0U)
+  switch (uart) {
+#if (RTE_UART0)
+    case 0U: return USART0_Info.irq_cycles;
+#endif
+#if (RTE_UART1)
+    case 1U: return USART1_Info.irq_cycles;
+#endif
+#if (RTE_UART2)
+    case 2U: return USART2_Info.irq_cycles;
+#endif
+#if (RTE_UART3)
+    case 3U: return USART3_Info.irq_cycles;
+#endif
+#if (RTE_UART4)
+    case 4U: return USART4_Info.irq_cycles;
+#endif
+    default: break;
+  }
+#else
+  (void)uart;
+#endif
+  return 0U;
+}
+
 
 #if (RTE_UART0)
 // USART0 Driver Wrapper functions
@@ -0,0 +1,46 @@
+/**
+ ********************************************************************************
+ * @file    eth_tap.h
+ * @author  prashanth kannan
+ * @date    2/28/24
+ * @brief   host Driver_ETH_MAC0 on a Linux TAP device or a frame loopback
+ ********************************************************************************
+ */
+
+#ifndef ETH_TAP_H
+#define ETH_TAP_H
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "stdint.h"
+
+// Drivers
+#include "Driver_ETH_MAC.h"
+
+/************************************
+ * MACROS AND DEFINES
+ ************************************/
+#define ETH_TAP_FRAME_MAX   (1514U)
+
+/************************************
+ * EXPORTED VARIABLES
+ ************************************/
+extern ARM_DRIVER_ETH_MAC Driver_ETH_MAC0;
+
+/************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ************************************/
+/*
+ * Frames go to and come from a TAP interface, it needs CAP_NET_ADMIN or a
+ * persistent device (ip tuntap add <name> mode tap user <user>). 0 on
+ * success. Without it frames stay in the loopback below.
+ */
+int32_t eth_tap_open(const char *name);
+
+// Loopback: queue a frame for ReadFrame, 0 on success
+int32_t eth_tap_inject(const void *frame, uint32_t len);
+// Loopback: take the oldest frame sent, its length or 0 when none
+uint32_t eth_tap_sent(uint8_t frame[ETH_TAP_FRAME_MAX]);
+
+#endif
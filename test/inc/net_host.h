@@ -0,0 +1,33 @@
+/**
+ ********************************************************************************
+ * @file    net_host.h
+ * @author  prashanth kannan
+ * @date    2/28/24
+ * @brief   host MAC glue for ip.c in place of the net task
+ ********************************************************************************
+ */
+
+#ifndef NET_HOST_H
+#define NET_HOST_H
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "stdint.h"
+
+// OS
+#include "FreeRTOS.h"
+
+/************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ************************************/
+// Bring Driver_ETH_MAC0 and the stack up, the link is up from the start
+void net_host_init(const uint8_t mac[6]);
+// Feed received frames to the stack, what the net task does on a notification
+uint32_t net_host_poll(void);
+// Move the tick count on and run the ARP timers
+void net_host_advance(TickType_t ticks);
+// Frame buffers not given back
+uint32_t net_host_bufs_used(void);
+
+#endif
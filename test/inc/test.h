@@ -0,0 +1,75 @@
+/**
+ ********************************************************************************
+ * @file    test.h
+ * @author  prashanth kannan
+ * @date    2/28/24
+ * @brief   host test checks and timing
+ ********************************************************************************
+ */
+
+#ifndef TEST_H
+#define TEST_H
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "stdint.h"
+#include "stdio.h"
+#include "time.h"
+
+/************************************
+ * MACROS AND DEFINES
+ ************************************/
+// Count and report a failed check, the test carries on
+#define CHECK(cond)         test_check((cond), #cond, __FILE__, __LINE__)
+
+/************************************
+ * EXPORTED VARIABLES
+ ************************************/
+static uint32_t test_failures;
+
+/************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ************************************/
+static inline int test_check(int ok, const char *cond, const char *file,
+    int line)
+{
+    if (!ok) {
+        printf("%s:%d: check failed: %s\n", file, line, cond);
+        test_failures++;
+    }
+    return ok;
+}
+
+// Exit status of the test
+static inline int test_result(const char *name)
+{
+    printf("%s: %s\n", name, test_failures ? "FAILED" : "passed");
+    return test_failures ? 1 : 0;
+}
+
+// Deterministic data for the checks
+static inline uint32_t test_rand(void)
+{
+    static uint32_t state = 0x12345678U;
+
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// Host cycle counter where there is one, nanoseconds otherwise
+static inline uint64_t test_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000U + ts.tv_nsec;
+#endif
+}
+
+#endif
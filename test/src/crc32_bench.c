@@ -0,0 +1,79 @@
+/**
+ ********************************************************************************
+ * @file    crc32_bench.c
+ * @author  prashanth kannan
+ * @date    2/28/24
+ * @brief   CRC32 cycles per byte, slice-by-4 against bit-serial
+ ********************************************************************************
+ */
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "stdint.h"
+
+// Drivers
+#include "CRC32.h"
+
+// TEST
+#include "test.h"
+
+/************************************
+ * PRIVATE MACROS AND DEFINES
+ ************************************/
+#define BENCH_RUNS          (2000U)
+
+/************************************
+ * STATIC FUNCTIONS
+ ************************************/
+static uint32_t crc32_bitwise(uint32_t crc, const uint8_t *data, uint32_t len)
+{
+    crc = ~crc;
+    while (len--) {
+        crc ^= *data++;
+        for (uint32_t n = 0; n < 8U; n++) {
+            crc = (crc >> 1) ^ ((crc & 1U) ? 0xEDB88320U : 0U);
+        }
+    }
+    return ~crc;
+}
+
+/************************************
+ * GLOBAL FUNCTIONS
+ ************************************/
+/*
+ * Host figures, the ratio carries over to the Cortex-M3 better than the
+ * absolute numbers
+ */
+int main(void)
+{
+    static const uint32_t sizes[] = { 6, 64, 1514 };
+    static uint8_t buf[1514];
+    volatile uint32_t sink = 0;
+
+    for (uint32_t i = 0; i < sizeof(buf); i++) {
+        buf[i] = (uint8_t)test_rand();
+    }
+
+    for (uint32_t i = 0; i < (sizeof(sizes) / sizeof(sizes[0])); i++) {
+        uint64_t start, table, bitwise;
+
+        start = test_cycles();
+        for (uint32_t n = 0; n < BENCH_RUNS; n++) {
+            sink += CRC32_Update(CRC32_INIT, buf, sizes[i]);
+        }
+        table = test_cycles() - start;
+
+        start = test_cycles();
+        for (uint32_t n = 0; n < BENCH_RUNS; n++) {
+            sink += crc32_bitwise(CRC32_INIT, buf, sizes[i]);
+        }
+        bitwise = test_cycles() - start;
+
+        printf("%4u bytes slice-by-4 %6.2f bit-serial %6.2f cycles/byte\n",
+            sizes[i], (double)table / BENCH_RUNS / sizes[i],
+            (double)bitwise / BENCH_RUNS / sizes[i]);
+    }
+
+    return 0;
+}
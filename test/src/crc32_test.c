@@ -0,0 +1,133 @@
+/**
+ ********************************************************************************
+ * @file    crc32_test.c
+ * @author  prashanth kannan
+ * @date    2/28/24
+ * @brief   CRC32 against known vectors and a bitwise reference
+ ********************************************************************************
+ */
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "stdint.h"
+#include "string.h"
+
+// Drivers
+#include "CRC32.h"
+
+// TEST
+#include "test.h"
+
+/************************************
+ * PRIVATE MACROS AND DEFINES
+ ************************************/
+#define BUF_SIZE            (300U)
+
+/************************************
+ * STATIC FUNCTIONS
+ ************************************/
+static uint32_t crc32_bitwise(uint32_t crc, const uint8_t *data, uint32_t len)
+{
+    crc = ~crc;
+    while (len--) {
+        crc ^= *data++;
+        for (uint32_t n = 0; n < 8U; n++) {
+            crc = (crc >> 1) ^ ((crc & 1U) ? 0xEDB88320U : 0U);
+        }
+    }
+    return ~crc;
+}
+
+static uint32_t rbit(uint32_t val)
+{
+    uint32_t res = 0;
+
+    for (uint32_t n = 0; n < 32U; n++) {
+        res = (res << 1) | ((val >> n) & 1U);
+    }
+    return res;
+}
+
+/*
+ * The bit-serial CRC the EMAC hash filter used before CRC32.c
+ */
+static uint32_t crc32_emac_old(const uint8_t *data, uint32_t len)
+{
+    uint32_t crc = 0xFFFFFFFFU;
+
+    while (len--) {
+        crc ^= rbit(*data++);
+        for (uint32_t n = 0; n < 8U; n++) {
+            crc = (crc << 1) ^ ((crc & 0x80000000U) ? 0x04C11DB7U : 0U);
+        }
+    }
+    return crc;
+}
+
+static void test_vectors(void)
+{
+    static const uint8_t zeros[32];
+
+    CHECK(CRC32_Update(CRC32_INIT, "", 0) == 0x00000000U);
+    CHECK(CRC32_Update(CRC32_INIT, "a", 1) == 0xE8B7BE43U);
+    CHECK(CRC32_Update(CRC32_INIT, "123456789", 9) == 0xCBF43926U);
+    CHECK(CRC32_Update(CRC32_INIT,
+        "The quick brown fox jumps over the lazy dog", 43) == 0x414FA339U);
+    CHECK(CRC32_Update(CRC32_INIT, zeros, sizeof(zeros)) == 0x190A55ADU);
+}
+
+/*
+ * Every start alignment and length against the reference, whole and split
+ */
+static void test_reference(void)
+{
+    static uint8_t buf[BUF_SIZE + 4U];
+
+    for (uint32_t i = 0; i < sizeof(buf); i++) {
+        buf[i] = (uint8_t)test_rand();
+    }
+
+    for (uint32_t align = 0; align < 4U; align++) {
+        for (uint32_t len = 0; len <= BUF_SIZE; len++) {
+            const uint8_t *p = &buf[align];
+            uint32_t ref = crc32_bitwise(CRC32_INIT, p, len);
+            uint32_t split = len / 3U;
+
+            if (!CHECK(CRC32_Update(CRC32_INIT, p, len) == ref)) {
+                printf("  align %u len %u\n", align, len);
+                return;
+            }
+            CHECK(CRC32_Update(CRC32_Update(CRC32_INIT, p, split),
+                &p[split], len - split) == ref);
+        }
+    }
+}
+
+/*
+ * Hash filter bins match the old bit-serial CRC
+ */
+static void test_emac_hash(void)
+{
+    uint8_t mac[6];
+
+    for (uint32_t i = 0; i < 1000U; i++) {
+        for (uint32_t n = 0; n < sizeof(mac); n++) {
+            mac[n] = (uint8_t)test_rand();
+        }
+        CHECK(((rbit(~CRC32_Update(CRC32_INIT, mac, sizeof(mac))) >> 23) & 0x3FU) ==
+            ((crc32_emac_old(mac, sizeof(mac)) >> 23) & 0x3FU));
+    }
+}
+
+/************************************
+ * GLOBAL FUNCTIONS
+ ************************************/
+int main(void)
+{
+    test_vectors();
+    test_reference();
+    test_emac_hash();
+
+    return test_result("crc32");
+}
@@ -0,0 +1,353 @@
+/**
+ ********************************************************************************
+ * @file    eth_tap.c
+ * @author  prashanth kannan
+ * @date    2/28/24
+ * @brief   host Driver_ETH_MAC0 on a Linux TAP device or a frame loopback
+ ********************************************************************************
+ */
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "stdint.h"
+#include "stdbool.h"
+#include "string.h"
+#include "fcntl.h"
+#include "unistd.h"
+#include "sys/ioctl.h"
+#include "linux/if.h"
+#include "linux/if_tun.h"
+
+// Drivers
+#include "Driver_ETH_MAC.h"
+#include "IP_CSUM.h"
+
+// TEST
+#include "eth_tap.h"
+
+/************************************
+ * PRIVATE MACROS AND DEFINES
+ ************************************/
+// Frames queued each way in the loopback
+#define LOOP_NUM            (8U)
+
+/************************************
+ * PRIVATE TYPEDEFS
+ ************************************/
+struct loop_frame {
+    uint32_t len;
+    uint8_t data[ETH_TAP_FRAME_MAX];
+};
+
+struct loop_queue {
+    struct loop_frame frame[LOOP_NUM];
+    uint32_t head;
+    uint32_t tail;
+};
+
+struct eth_ctx {
+    int fd;                 // TAP device, -1 for the loopback
+    ARM_ETH_MAC_ADDR addr;
+    uint32_t config;        // ARM_ETH_MAC_CONFIGURE argument
+    bool rx_on;
+    bool tx_on;
+    struct loop_frame rx;   // frame read from the TAP, waiting for ReadFrame
+    struct loop_queue to_mac;
+    struct loop_queue from_mac;
+};
+
+/************************************
+ * STATIC VARIABLES
+ ************************************/
+static struct eth_ctx ctx = { .fd = -1 };
+
+/************************************
+ * STATIC FUNCTIONS
+ ************************************/
+static bool loop_put(struct loop_queue *q, const void *data, uint32_t len)
+{
+    if (((q->head - q->tail) == LOOP_NUM) || (len > ETH_TAP_FRAME_MAX)) {
+        return false;
+    }
+    q->frame[q->head % LOOP_NUM].len = len;
+    memcpy(q->frame[q->head % LOOP_NUM].data, data, len);
+    q->head++;
+    return true;
+}
+
+static struct loop_frame *loop_peek(struct loop_queue *q)
+{
+    return (q->head != q->tail) ? &q->frame[q->tail % LOOP_NUM] : NULL;
+}
+
+/*
+ * Next received frame, NULL when none
+ */
+static struct loop_frame *rx_frame(void)
+{
+    ssize_t len;
+
+    if (ctx.fd < 0) {
+        return loop_peek(&ctx.to_mac);
+    }
+
+    if (!ctx.rx.len) {
+        len = read(ctx.fd, ctx.rx.data, sizeof(ctx.rx.data));
+        ctx.rx.len = (len > 0) ? (uint32_t)len : 0U;
+    }
+    return ctx.rx.len ? &ctx.rx : NULL;
+}
+
+static void rx_release(void)
+{
+    if (ctx.fd < 0) {
+        ctx.to_mac.tail++;
+    } else {
+        ctx.rx.len = 0;
+    }
+}
+
+static ARM_DRIVER_VERSION GetVersion(void)
+{
+    ARM_DRIVER_VERSION version = { ARM_ETH_MAC_API_VERSION, 0x0100U };
+
+    return version;
+}
+
+static ARM_ETH_MAC_CAPABILITIES GetCapabilities(void)
+{
+    ARM_ETH_MAC_CAPABILITIES cap = {
+        .checksum_offload_rx_ip4 = 1U,
+        .checksum_offload_rx_udp = 1U,
+        .checksum_offload_rx_tcp = 1U,
+        .checksum_offload_rx_icmp = 1U,
+        .media_interface = ARM_ETH_INTERFACE_RMII,
+        .mac_address = 0U,
+    };
+
+    return cap;
+}
+
+static int32_t Initialize(ARM_ETH_MAC_SignalEvent_t cb_event)
+{
+    (void)cb_event;
+    return ARM_DRIVER_OK;
+}
+
+static int32_t Uninitialize(void)
+{
+    return ARM_DRIVER_OK;
+}
+
+static int32_t PowerControl(ARM_POWER_STATE state)
+{
+    (void)state;
+    return ARM_DRIVER_OK;
+}
+
+static int32_t GetMacAddress(ARM_ETH_MAC_ADDR *ptr_addr)
+{
+    *ptr_addr = ctx.addr;
+    return ARM_DRIVER_OK;
+}
+
+static int32_t SetMacAddress(const ARM_ETH_MAC_ADDR *ptr_addr)
+{
+    ctx.addr = *ptr_addr;
+    return ARM_DRIVER_OK;
+}
+
+static int32_t SetAddressFilter(const ARM_ETH_MAC_ADDR *ptr_addr,
+    uint32_t num_addr)
+{
+    (void)ptr_addr;
+    (void)num_addr;
+    return ARM_DRIVER_OK;
+}
+
+/*
+ * Whole frames only, the stack builds each frame in one buffer
+ */
+static int32_t SendFrame(const uint8_t *frame, uint32_t len, uint32_t flags)
+{
+    if (!frame || !len || (len > ETH_TAP_FRAME_MAX) ||
+        (flags & ARM_ETH_MAC_TX_FRAME_FRAGMENT)) {
+        return ARM_DRIVER_ERROR_PARAMETER;
+    }
+    if (!ctx.tx_on) {
+        return ARM_DRIVER_ERROR;
+    }
+
+    if (ctx.fd >= 0) {
+        return (write(ctx.fd, frame, len) == (ssize_t)len) ?
+            ARM_DRIVER_OK : ARM_DRIVER_ERROR;
+    }
+    return loop_put(&ctx.from_mac, frame, len) ?
+        ARM_DRIVER_OK : ARM_DRIVER_ERROR_BUSY;
+}
+
+/*
+ * Checksums are checked like the EMAC does when offload is configured
+ */
+static int32_t ReadFrame(uint8_t *frame, uint32_t len)
+{
+    struct loop_frame *rx = rx_frame();
+    int32_t ret = (int32_t)len;
+
+    if (!rx) {
+        return ARM_DRIVER_ERROR;
+    }
+
+    if (len > rx->len) {
+        len = rx->len;
+        ret = (int32_t)len;
+    }
+    memcpy(frame, rx->data, len);
+    if ((ctx.config & ARM_ETH_MAC_CHECKSUM_OFFLOAD_RX) && (len == rx->len) &&
+        !IP_CSUM_FrameCheck(frame, len, IP_CSUM_Add(0, frame, len))) {
+        ret = ARM_DRIVER_ERROR;
+    }
+    rx_release();
+
+    return ret;
+}
+
+static uint32_t GetRxFrameSize(void)
+{
+    struct loop_frame *rx;
+
+    if (!ctx.rx_on) {
+        return 0;
+    }
+    rx = rx_frame();
+    return rx ? rx->len : 0U;
+}
+
+static int32_t GetRxFrameTime(ARM_ETH_MAC_TIME *time)
+{
+    (void)time;
+    return ARM_DRIVER_ERROR_UNSUPPORTED;
+}
+
+static int32_t GetTxFrameTime(ARM_ETH_MAC_TIME *time)
+{
+    (void)time;
+    return ARM_DRIVER_ERROR_UNSUPPORTED;
+}
+
+static int32_t ControlTimer(uint32_t control, ARM_ETH_MAC_TIME *time)
+{
+    (void)control;
+    (void)time;
+    return ARM_DRIVER_ERROR_UNSUPPORTED;
+}
+
+static int32_t Control(uint32_t control, uint32_t arg)
+{
+    switch (control) {
+    case ARM_ETH_MAC_CONFIGURE:
+        ctx.config = arg;
+        break;
+    case ARM_ETH_MAC_CONTROL_TX:
+        ctx.tx_on = (arg != 0);
+        break;
+    case ARM_ETH_MAC_CONTROL_RX:
+        ctx.rx_on = (arg != 0);
+        break;
+    case ARM_ETH_MAC_FLUSH:
+        if (arg & ARM_ETH_MAC_FLUSH_RX) {
+            ctx.to_mac.tail = ctx.to_mac.head;
+            ctx.rx.len = 0;
+        }
+        if (arg & ARM_ETH_MAC_FLUSH_TX) {
+            ctx.from_mac.tail = ctx.from_mac.head;
+        }
+        break;
+    default:
+        return ARM_DRIVER_ERROR_UNSUPPORTED;
+    }
+    return ARM_DRIVER_OK;
+}
+
+static int32_t PHY_Read(uint8_t phy_addr, uint8_t reg_addr, uint16_t *data)
+{
+    (void)phy_addr;
+    (void)reg_addr;
+    *data = 0;
+    return ARM_DRIVER_OK;
+}
+
+static int32_t PHY_Write(uint8_t phy_addr, uint8_t reg_addr, uint16_t data)
+{
+    (void)phy_addr;
+    (void)reg_addr;
+    (void)data;
+    return ARM_DRIVER_OK;
+}
+
+/************************************
+ * GLOBAL VARIABLES
+ ************************************/
+ARM_DRIVER_ETH_MAC Driver_ETH_MAC0 = {
+    GetVersion,
+    GetCapabilities,
+    Initialize,
+    Uninitialize,
+    PowerControl,
+    GetMacAddress,
+    SetMacAddress,
+    SetAddressFilter,
+    SendFrame,
+    ReadFrame,
+    GetRxFrameSize,
+    GetRxFrameTime,
+    GetTxFrameTime,
+    ControlTimer,
+    Control,
+    PHY_Read,
+    PHY_Write,
+};
+
+/************************************
+ * GLOBAL FUNCTIONS
+ ************************************/
+int32_t eth_tap_open(const char *name)
+{
+    struct ifreq ifr;
+    int fd = open("/dev/net/tun", O_RDWR | O_NONBLOCK);
+
+    if (fd < 0) {
+        return -1;
+    }
+
+    memset(&ifr, 0, sizeof(ifr));
+    ifr.ifr_flags = IFF_TAP | IFF_NO_PI;
+    strncpy(ifr.ifr_name, name, IFNAMSIZ - 1);
+    if (ioctl(fd, TUNSETIFF, &ifr) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    ctx.fd = fd;
+    return 0;
+}
+
+int32_t eth_tap_inject(const void *frame, uint32_t len)
+{
+    return loop_put(&ctx.to_mac, frame, len) ? 0 : -1;
+}
+
+uint32_t eth_tap_sent(uint8_t frame[ETH_TAP_FRAME_MAX])
+{
+    struct loop_frame *tx = loop_peek(&ctx.from_mac);
+    uint32_t len;
+
+    if (!tx) {
+        return 0;
+    }
+    len = tx->len;
+    memcpy(frame, tx->data, len);
+    ctx.from_mac.tail++;
+    return len;
+}
@@ -0,0 +1,89 @@
+/**
+ ********************************************************************************
+ * @file    format_bench.c
+ * @author  prashanth kannan
+ * @date    2/28/24
+ * @brief   printf engine cycles per call against the host snprintf
+ ********************************************************************************
+ */
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "stdint.h"
+#include "stdarg.h"
+
+// APPS
+#include "format.h"
+
+// TEST
+#include "test.h"
+
+/************************************
+ * PRIVATE MACROS AND DEFINES
+ ************************************/
+#define BENCH_RUNS          (200000U)
+#define BUF_SIZE            (128U)
+
+// Time both formatters on one format and argument list
+#define BENCH(name, format, ...) \
+    do { \
+        uint64_t start, engine, libc; \
+        start = test_cycles(); \
+        for (uint32_t n = 0; n < BENCH_RUNS; n++) { \
+            sink += fmt(buf, sizeof(buf), (format), ##__VA_ARGS__); \
+        } \
+        engine = test_cycles() - start; \
+        start = test_cycles(); \
+        for (uint32_t n = 0; n < BENCH_RUNS; n++) { \
+            sink += snprintf(buf, sizeof(buf), (format), ##__VA_ARGS__); \
+        } \
+        libc = test_cycles() - start; \
+        printf("%-8s fmt_snformat %7.1f snprintf %7.1f cycles/call\n", (name), \
+            (double)engine / BENCH_RUNS, (double)libc / BENCH_RUNS); \
+    } while (0)
+
+/************************************
+ * STATIC FUNCTIONS
+ ************************************/
+static int fmt(char *buf, size_t size, const char *format, ...)
+{
+    struct fmt_args args;
+    va_list va;
+    int n;
+
+    va_start(va, format);
+    args = (struct fmt_args){ .va = &va };
+    n = fmt_snformat(buf, size, format, &args);
+    va_end(va);
+
+    return n;
+}
+
+/************************************
+ * GLOBAL FUNCTIONS
+ ************************************/
+/*
+ * Host figures against the host libc, newlib-nano only exists for the target.
+ * The ratio carries over better than the absolute numbers, code size comes
+ * from the target build.
+ */
+int main(void)
+{
+    static char buf[BUF_SIZE];
+    volatile int sink = 0;
+    volatile uint32_t val = 123456789U;
+
+    BENCH("text", "serial up\r\n");
+    BENCH("decimal", "rx frames %lu bytes %lu crc %lu\r\n", (unsigned long)val,
+        (unsigned long)(val >> 3), (unsigned long)(val >> 20));
+    BENCH("hex", "mac %02x:%02x:%02x:%02x:%02x:%02x\r\n", 0x00, 0x1a, 0xb6,
+        val & 0xFFU, 0x7f, 0x10);
+    BENCH("string", "%-8s %s\r\n", "hbeat", "debug");
+    BENCH("64-bit", "uptime %llu us\r\n", (unsigned long long)val * 1000U);
+#if FMT_FLOAT_EN
+    BENCH("float", "temp %.2f C\r\n", val / 4000000.0);
+#endif
+
+    return 0;
+}
@@ -0,0 +1,177 @@
+/**
+ ********************************************************************************
+ * @file    format_test.c
+ * @author  prashanth kannan
+ * @date    2/28/24
+ * @brief   printf engine against the host snprintf
+ ********************************************************************************
+ */
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "stdint.h"
+#include "stddef.h"
+#include "stdarg.h"
+#include "string.h"
+
+// APPS
+#include "format.h"
+
+// TEST
+#include "test.h"
+
+/************************************
+ * PRIVATE MACROS AND DEFINES
+ ************************************/
+#define BUF_SIZE            (128U)
+#define RAND_RUNS           (20000U)
+
+#define ARRAY_SIZE(a)       (sizeof(a) / sizeof((a)[0]))
+
+// Format both ways and compare the text and the returned length
+#define CHECK_FMT(size, format, ...) \
+    check_fmt(__LINE__, (size), (format), \
+        snprintf(ref, (size), (format), ##__VA_ARGS__), ##__VA_ARGS__)
+
+/************************************
+ * STATIC VARIABLES
+ ************************************/
+static char ref[BUF_SIZE];
+
+/************************************
+ * STATIC FUNCTIONS
+ ************************************/
+static void check_fmt(int line, size_t size, const char *format, int ref_n, ...)
+{
+    char buf[BUF_SIZE];
+    struct fmt_args args;
+    va_list va;
+    int n;
+
+    memset(buf, 0x55, sizeof(buf));
+    va_start(va, ref_n);
+    args = (struct fmt_args){ .va = &va };
+    n = fmt_snformat(buf, size, format, &args);
+    va_end(va);
+
+    if ((n != ref_n) || (size && strcmp(buf, ref))) {
+        printf("line %d: \"%s\" gave \"%s\" (%d), expected \"%s\" (%d)\n",
+            line, format, size ? buf : "", n, size ? ref : "", ref_n);
+        test_failures++;
+    }
+}
+
+static void test_ints(void)
+{
+    CHECK_FMT(BUF_SIZE, "%d %i %u", 0, -1, 4000000000U);
+    CHECK_FMT(BUF_SIZE, "%d %d", INT32_MAX, INT32_MIN);
+    CHECK_FMT(BUF_SIZE, "[%5d] [%-5d] [%05d] [%+d] [% d]", 42, 42, -42, 42, 42);
+    CHECK_FMT(BUF_SIZE, "[%.3d] [%8.3d] [%-8.3d] [%08d]", 7, -7, 7, 7);
+    CHECK_FMT(BUF_SIZE, "[%.0d] [%5.0d] [%+.0d]", 0, 0, 0);
+    CHECK_FMT(BUF_SIZE, "%o %#o %x %#x %X %#X", 8, 8, 255, 255, 255, 255);
+    CHECK_FMT(BUF_SIZE, "[%#08x] [%-#8x] [%#.5o] [%#x]", 0x1f, 0x1f, 8, 0);
+    CHECK_FMT(BUF_SIZE, "%hhd %hhu %hd %hu", 300, 300, 70000, 70000);
+    CHECK_FMT(BUF_SIZE, "%ld %lu %lx", -123456L, 123456UL, 0xdeadUL);
+    CHECK_FMT(BUF_SIZE, "%lld %llu %llx %llo", (long long)INT64_MIN,
+        (unsigned long long)UINT64_MAX, 0x123456789abcdefULL,
+        01234567012345670ULL);
+    CHECK_FMT(BUF_SIZE, "%jd %zu %td", (intmax_t)-5, (size_t)5, (ptrdiff_t)-5);
+    CHECK_FMT(BUF_SIZE, "[%*d] [%-*d] [%.*d] [%*d]", 6, 1, 6, 1, 4, 1, -6, 1);
+}
+
+static void test_other(void)
+{
+    CHECK_FMT(BUF_SIZE, "[%c] [%3c] [%-3c]", 'a', 'b', 'c');
+    CHECK_FMT(BUF_SIZE, "[%s] [%8s] [%-8s] [%.2s] [%8.2s]", "abc", "abc", "abc",
+        "abc", "abc");
+    CHECK_FMT(BUF_SIZE, "[%.*s] [%s]", 3, "abcdef", "");
+    // Pointers are 32 bits on the target
+    CHECK_FMT(BUF_SIZE, "%p", (void *)(uintptr_t)0x2007c010U);
+    CHECK_FMT(BUF_SIZE, "100%% %d%%", 5);
+    CHECK_FMT(BUF_SIZE, "no conversions");
+    CHECK_FMT(BUF_SIZE, "");
+}
+
+/*
+ * Values exact in binary and clear of rounding ties, which the engine rounds
+ * half up, with at most the 9 fraction digits it produces
+ */
+static void test_float(void)
+{
+#if FMT_FLOAT_EN
+    CHECK_FMT(BUF_SIZE, "%f %f %f", 0.0, 1.5, -3.125);
+    CHECK_FMT(BUF_SIZE, "%.0f %.1f %.2f %.3f", 2.25, 0.7578125, 10.06640625,
+        7.81640625);
+    CHECK_FMT(BUF_SIZE, "[%10.2f] [%-10.2f] [%010.2f] [%+.1f] [% .1f]", 3.75,
+        3.75, -3.75, 3.75, 3.75);
+    CHECK_FMT(BUF_SIZE, "%#.0f %F %.9f", 5.0, 123456789.0, 0.001953125);
+#endif
+}
+
+/*
+ * Output cut to the buffer, the length is still the full one
+ */
+static void test_truncate(void)
+{
+    CHECK_FMT(1, "%d", 12345);
+    CHECK_FMT(4, "%d", 12345);
+    CHECK_FMT(6, "%s-%s", "abc", "def");
+    CHECK_FMT(0, "%s", "abc");
+}
+
+/*
+ * 32-bit argument array as the deferred ISR records use, 64-bit values take
+ * two words, low word first
+ */
+static void test_argv(void)
+{
+    const uint32_t argv[] = { (uint32_t)-17, 0xbeef, 0x9abcdef0U, 0x12345678U };
+    struct fmt_args args = { .argv = argv, .argc = ARRAY_SIZE(argv) };
+    char buf[BUF_SIZE];
+    int n;
+
+    n = fmt_snformat(buf, sizeof(buf), "%d %#x %llx", &args);
+    CHECK(n == snprintf(ref, sizeof(ref), "%d %#x %llx", -17, 0xbeef,
+        0x123456789abcdef0ULL));
+    CHECK(!strcmp(buf, ref));
+}
+
+/*
+ * Random values through random integer specs
+ */
+static void test_random(void)
+{
+    static const char *const specs[] = {
+        "%d", "%u", "%x", "%X", "%o", "%#x", "%#o", "%+d", "% d", "%-12d",
+        "%012d", "%.7d", "%12.5d", "%-#12x", "%+012d", "%#012o",
+    };
+    static const char *const specs64[] = {
+        "%lld", "%llu", "%llx", "%#llo", "%-24lld", "%024llu", "%.20lld",
+    };
+
+    for (uint32_t i = 0; i < RAND_RUNS; i++) {
+        const char *spec = specs[test_rand() % ARRAY_SIZE(specs)];
+        const char *spec64 = specs64[test_rand() % ARRAY_SIZE(specs64)];
+        uint32_t val = test_rand() >> (test_rand() % 32U);
+        uint64_t val64 = ((uint64_t)test_rand() << 32 | test_rand()) >> (test_rand() % 64U);
+
+        CHECK_FMT(BUF_SIZE, spec, val);
+        CHECK_FMT(BUF_SIZE, spec64, val64);
+    }
+}
+
+/************************************
+ * GLOBAL FUNCTIONS
+ ************************************/
+int main(void)
+{
+    test_ints();
+    test_other();
+    test_float();
+    test_truncate();
+    test_argv();
+    test_random();
+
+    return test_result("format");
+}
@@ -0,0 +1,256 @@
+/**
+ ********************************************************************************
+ * @file    ip_csum_test.c
+ * @author  prashanth kannan
+ * @date    2/28/24
+ * @brief   Internet checksum against an RFC 1071 reference
+ ********************************************************************************
+ */
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "stdint.h"
+#include "stdbool.h"
+#include "string.h"
+
+// Drivers
+#include "IP_CSUM.h"
+
+// TEST
+#include "test.h"
+
+/************************************
+ * PRIVATE MACROS AND DEFINES
+ ************************************/
+#define BUF_SIZE            (200U)
+#define FRAME_RUNS          (3000U)
+
+#define ETH_HDR_LEN         (14U)
+#define IP_PROTO_ICMP       (1U)
+#define IP_PROTO_TCP        (6U)
+#define IP_PROTO_UDP        (17U)
+
+/************************************
+ * STATIC FUNCTIONS
+ ************************************/
+/*
+ * Big-endian 16-bit words as in RFC 1071, odd length padded with zero
+ */
+static uint32_t ref_sum(uint32_t sum, const uint8_t *data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i += 2U) {
+        sum += (uint32_t)data[i] << 8;
+        if ((i + 1U) < len) {
+            sum += data[i + 1U];
+        }
+        sum = (sum & 0xFFFFU) + (sum >> 16);
+    }
+    return sum;
+}
+
+static uint16_t get16(const uint8_t *p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+// IP_CSUM sums in memory order, the reference in network order
+static uint16_t swap16(uint32_t val)
+{
+    return (uint16_t)(((val << 8) | (val >> 8)) & 0xFFFFU);
+}
+
+/*
+ * Every start alignment and length, whole, copied and split at odd offsets
+ */
+static void test_blocks(void)
+{
+    static uint8_t buf[BUF_SIZE + 4U];
+    static uint8_t copy[BUF_SIZE + 4U];
+
+    for (uint32_t i = 0; i < sizeof(buf); i++) {
+        buf[i] = (uint8_t)test_rand();
+    }
+    // Carries out of every word
+    memset(&buf[100], 0xFF, 40);
+
+    for (uint32_t align = 0; align < 4U; align++) {
+        for (uint32_t len = 0; len <= BUF_SIZE; len++) {
+            const uint8_t *p = &buf[align];
+            uint16_t ref = (uint16_t)ref_sum(0, p, len);
+            uint32_t split = len / 3U;
+            uint32_t sum;
+
+            if (!CHECK(swap16(IP_CSUM_Fold(IP_CSUM_Add(0, p, len))) == ref)) {
+                printf("  align %u len %u\n", align, len);
+                return;
+            }
+
+            memset(copy, 0, sizeof(copy));
+            sum = IP_CSUM_Copy(0, &copy[3U - align], p, len);
+            CHECK(swap16(IP_CSUM_Fold(sum)) == ref);
+            CHECK(!memcmp(&copy[3U - align], p, len));
+
+            sum = IP_CSUM_Add(0, &p[split], len - split);
+            if (split & 1U) {
+                sum = IP_CSUM_Swap(sum);
+            }
+            sum = IP_CSUM_Merge(IP_CSUM_Add(0, p, split), sum);
+            CHECK(swap16(IP_CSUM_Fold(sum)) == ref);
+        }
+    }
+}
+
+/*
+ * Random IPv4 frame with header options and Ethernet padding sometimes,
+ * checksum fields left with garbage. Returns the frame length.
+ */
+static uint32_t make_frame(uint8_t *frame, uint8_t proto, uint32_t *l4,
+    uint32_t *end)
+{
+    uint32_t hlen = (test_rand() & 1U) ? 20U : 24U;
+    uint32_t plen = (proto == IP_PROTO_TCP) ? 20U : 8U;
+    uint32_t pad;
+
+    plen += test_rand() % 200U;
+    pad = (test_rand() & 1U) ? (test_rand() % 8U) : 0U;
+
+    for (uint32_t i = 0; i < (ETH_HDR_LEN + hlen + plen + pad); i++) {
+        frame[i] = (uint8_t)test_rand();
+    }
+    frame[12] = 0x08U;
+    frame[13] = 0x00U;
+    frame[ETH_HDR_LEN + 0U] = (uint8_t)(0x40U | (hlen / 4U));
+    frame[ETH_HDR_LEN + 2U] = (uint8_t)((hlen + plen) >> 8);
+    frame[ETH_HDR_LEN + 3U] = (uint8_t)(hlen + plen);
+    frame[ETH_HDR_LEN + 6U] = 0x40U;    // don't fragment
+    frame[ETH_HDR_LEN + 7U] = 0U;
+    frame[ETH_HDR_LEN + 9U] = proto;
+    if (proto == IP_PROTO_UDP) {
+        frame[ETH_HDR_LEN + hlen + 4U] = (uint8_t)(plen >> 8);
+        frame[ETH_HDR_LEN + hlen + 5U] = (uint8_t)plen;
+    }
+
+    *l4 = ETH_HDR_LEN + hlen;
+    *end = ETH_HDR_LEN + hlen + plen;
+    return *end + pad;
+}
+
+static bool ref_frame_ok(const uint8_t *frame, uint32_t l4, uint32_t end)
+{
+    const uint8_t *ip = &frame[ETH_HDR_LEN];
+    uint32_t sum = 0;
+    uint8_t pseudo[4];
+
+    if (ref_sum(0, ip, l4 - ETH_HDR_LEN) != 0xFFFFU) {
+        return false;
+    }
+
+    if (ip[9] != IP_PROTO_ICMP) {
+        pseudo[0] = 0U;
+        pseudo[1] = ip[9];
+        pseudo[2] = (uint8_t)((end - l4) >> 8);
+        pseudo[3] = (uint8_t)(end - l4);
+        sum = ref_sum(ref_sum(0, &ip[12], 8U), pseudo, sizeof(pseudo));
+    }
+    return ref_sum(sum, &frame[l4], end - l4) == 0xFFFFU;
+}
+
+/*
+ * IP_CSUM_FrameInsert output checks against the reference, and
+ * IP_CSUM_FrameCheck takes it and rejects a damaged payload
+ */
+static void test_frames(void)
+{
+    static const uint8_t protos[] = { IP_PROTO_ICMP, IP_PROTO_UDP, IP_PROTO_TCP };
+    static uint8_t frame[1600];
+    uint32_t len, l4, end, pos;
+
+    for (uint32_t i = 0; i < FRAME_RUNS; i++) {
+        uint8_t proto = protos[i % sizeof(protos)];
+        uint32_t field = (proto == IP_PROTO_ICMP) ? 2U :
+            ((proto == IP_PROTO_UDP) ? 6U : 16U);
+
+        len = make_frame(frame, proto, &l4, &end);
+        IP_CSUM_FrameInsert(frame, len, IP_CSUM_Add(0, frame, len));
+
+        if (!CHECK(ref_frame_ok(frame, l4, end))) {
+            printf("  proto %u len %u\n", proto, len);
+            return;
+        }
+        CHECK(IP_CSUM_FrameCheck(frame, len, IP_CSUM_Add(0, frame, len)));
+        if (proto == IP_PROTO_UDP) {
+            CHECK(get16(&frame[l4 + field]) != 0U);
+        }
+
+        // Any payload byte but the checksum field
+        do {
+            pos = l4 + (test_rand() % (end - l4));
+        } while ((pos == (l4 + field)) || (pos == (l4 + field + 1U)));
+        frame[pos] ^= (uint8_t)(1U + (test_rand() % 255U));
+        CHECK(!IP_CSUM_FrameCheck(frame, len, IP_CSUM_Add(0, frame, len)));
+    }
+
+    // UDP without checksum passes
+    len = make_frame(frame, IP_PROTO_UDP, &l4, &end);
+    IP_CSUM_FrameInsert(frame, len, IP_CSUM_Add(0, frame, len));
+    frame[l4 + 6U] = 0U;
+    frame[l4 + 7U] = 0U;
+    CHECK(IP_CSUM_FrameCheck(frame, len, IP_CSUM_Add(0, frame, len)));
+
+    // Fragments are left alone
+    len = make_frame(frame, IP_PROTO_UDP, &l4, &end);
+    frame[ETH_HDR_LEN + 6U] = 0x20U;    // more fragments
+    frame[l4 + 6U] = 0x12U;
+    frame[l4 + 7U] = 0x34U;
+    IP_CSUM_FrameInsert(frame, len, IP_CSUM_Add(0, frame, len));
+    CHECK(get16(&frame[l4 + 6U]) == 0x1234U);
+    CHECK(ref_sum(0, &frame[ETH_HDR_LEN], l4 - ETH_HDR_LEN) == 0xFFFFU);
+}
+
+/*
+ * Frames sent from fragments: headers in the first, the datagram summed
+ * piece by piece as the EMAC driver does over its Tx descriptors
+ */
+static void test_fragments(void)
+{
+    static uint8_t frame[1600];
+    uint32_t len, l4, end, size, split, sum, part;
+
+    for (uint32_t i = 0; i < FRAME_RUNS; i++) {
+        uint8_t proto = (i & 1U) ? IP_PROTO_UDP : IP_PROTO_TCP;
+        uint32_t field = (proto == IP_PROTO_UDP) ? 6U : 16U;
+
+        len = make_frame(frame, proto, &l4, &end);
+        size = l4 + field + 2U + (test_rand() % (end - l4 - field - 1U));
+        CHECK(IP_CSUM_FrameEnd(frame, size, len) == end);
+        CHECK(IP_CSUM_FrameEnd(frame, l4 + field + 1U, len) == 0U);
+
+        // Second fragment split again at any offset, odd ones included
+        split = size + ((end > size) ? (test_rand() % (end - size)) : 0U);
+        sum = IP_CSUM_Add(0, frame, size);
+        part = IP_CSUM_Add(0, &frame[size], split - size);
+        sum = IP_CSUM_Merge(sum, (size & 1U) ? IP_CSUM_Swap(part) : part);
+        part = IP_CSUM_Add(0, &frame[split], end - split);
+        sum = IP_CSUM_Merge(sum, (split & 1U) ? IP_CSUM_Swap(part) : part);
+
+        IP_CSUM_FrameInsert(frame, end, sum);
+        if (!CHECK(ref_frame_ok(frame, l4, end))) {
+            printf("  proto %u len %u size %u split %u\n", proto, len, size,
+                split);
+            return;
+        }
+    }
+}
+
+/************************************
+ * GLOBAL FUNCTIONS
+ ************************************/
+int main(void)
+{
+    test_blocks();
+    test_frames();
+    test_fragments();
+
+    return test_result("ip_csum");
+}
@@ -0,0 +1,172 @@
+/**
+ ********************************************************************************
+ * @file    net_host.c
+ * @author  prashanth kannan
+ * @date    2/28/24
+ * @brief   host MAC glue for ip.c in place of the net task
+ ********************************************************************************
+ */
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "stdint.h"
+#include "stdbool.h"
+#include "assert.h"
+
+// Drivers
+#include "Driver_ETH_MAC.h"
+
+// OS
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+// APPS
+#include "net.h"
+#include "ip.h"
+
+// TEST
+#include "net_host.h"
+
+/************************************
+ * EXTERN VARIABLES
+ ************************************/
+extern ARM_DRIVER_ETH_MAC Driver_ETH_MAC0;
+
+/************************************
+ * PRIVATE MACROS AND DEFINES
+ ************************************/
+// Same pool size as net.c
+#define NET_BUF_NUM         (4U)
+
+/************************************
+ * PRIVATE TYPEDEFS
+ ************************************/
+struct net_host_ctx {
+    TickType_t ticks;
+    uint32_t buf_free;      // bit per free buffer
+};
+
+/************************************
+ * STATIC VARIABLES
+ ************************************/
+static struct net_host_ctx ctx = {
+    .buf_free = (1UL << NET_BUF_NUM) - 1U,
+};
+
+static uint8_t net_buf[NET_BUF_NUM][NET_BUF_SIZE];
+static uint8_t rx_buf[NET_BUF_SIZE];
+
+/************************************
+ * GLOBAL VARIABLES
+ ************************************/
+struct net_stats net_stats;
+int host_mutex;
+
+/************************************
+ * GLOBAL FUNCTIONS
+ ************************************/
+TickType_t xTaskGetTickCount(void)
+{
+    return ctx.ticks;
+}
+
+bool net_link_up(void)
+{
+    return true;
+}
+
+uint8_t *net_buf_alloc(void)
+{
+    for (uint32_t n = 0; n < NET_BUF_NUM; n++) {
+        if (ctx.buf_free & (1UL << n)) {
+            ctx.buf_free &= ~(1UL << n);
+            return net_buf[n];
+        }
+    }
+    return NULL;
+}
+
+void net_buf_free(uint8_t *buf)
+{
+    uint32_t n = (uint32_t)((buf - &net_buf[0][0]) / NET_BUF_SIZE);
+
+    assert(n < NET_BUF_NUM);
+    assert(!(ctx.buf_free & (1UL << n)));
+    ctx.buf_free |= 1UL << n;
+}
+
+/*
+ * Copied out at once, so the buffer is free again before returning
+ */
+int32_t net_xmit(uint8_t *buf, uint32_t len)
+{
+    int32_t ret;
+
+    // Callers hold the ip lock
+    assert(host_mutex == 1);
+
+    ret = Driver_ETH_MAC0.SendFrame(buf, len, 0);
+    net_buf_free(buf);
+    if (ret) {
+        net_stats.tx_dropped++;
+        return -1;
+    }
+
+    net_stats.tx_frames++;
+    return 0;
+}
+
+void net_host_init(const uint8_t mac[6])
+{
+    ARM_ETH_MAC_ADDR addr;
+
+    for (uint32_t i = 0; i < sizeof(addr.b); i++) {
+        addr.b[i] = mac[i];
+    }
+
+    Driver_ETH_MAC0.Initialize(NULL);
+    Driver_ETH_MAC0.PowerControl(ARM_POWER_FULL);
+    Driver_ETH_MAC0.SetMacAddress(&addr);
+    Driver_ETH_MAC0.Control(ARM_ETH_MAC_CONFIGURE, ARM_ETH_MAC_SPEED_100M |
+        ARM_ETH_MAC_DUPLEX_FULL | ARM_ETH_MAC_ADDRESS_BROADCAST |
+        ARM_ETH_MAC_CHECKSUM_OFFLOAD_RX);
+    Driver_ETH_MAC0.Control(ARM_ETH_MAC_CONTROL_TX, 1);
+    Driver_ETH_MAC0.Control(ARM_ETH_MAC_CONTROL_RX, 1);
+
+    ip_init(mac);
+}
+
+uint32_t net_host_poll(void)
+{
+    uint32_t count = 0;
+    uint32_t size;
+    int32_t len;
+
+    while ((size = Driver_ETH_MAC0.GetRxFrameSize()) != 0) {
+        count++;
+        len = Driver_ETH_MAC0.ReadFrame(rx_buf,
+            (size < sizeof(rx_buf)) ? size : sizeof(rx_buf));
+        if (len < 0) {
+            net_stats.rx_errors++;
+            continue;
+        }
+        net_stats.rx_frames++;
+        ip_input(rx_buf, (uint32_t)len);
+        assert(host_mutex == 0);
+    }
+
+    return count;
+}
+
+void net_host_advance(TickType_t ticks)
+{
+    ctx.ticks += ticks;
+    ip_tick();
+}
+
+uint32_t net_host_bufs_used(void)
+{
+    return NET_BUF_NUM - (uint32_t)__builtin_popcount(ctx.buf_free);
+}
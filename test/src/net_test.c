@@ -0,0 +1,374 @@
+/**
+ ********************************************************************************
+ * @file    net_test.c
+ * @author  prashanth kannan
+ * @date    2/28/24
+ * @brief   ARP, ICMP echo and UDP of ip.c over the host MAC stand-in
+ ********************************************************************************
+ */
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "stdint.h"
+#include "stdbool.h"
+#include "stdio.h"
+#include "string.h"
+#include "unistd.h"
+
+// Drivers
+#include "IP_CSUM.h"
+
+// APPS
+#include "net.h"
+#include "ip.h"
+
+// TEST
+#include "test.h"
+#include "eth_tap.h"
+#include "net_host.h"
+
+/************************************
+ * PRIVATE MACROS AND DEFINES
+ ************************************/
+// ip.c defaults
+#define LOCAL_IP            NET_IP4(192, 168, 1, 50)
+#define PEER_IP             NET_IP4(192, 168, 1, 1)     // also the gateway
+#define OTHER_IP            NET_IP4(192, 168, 1, 2)
+#define REMOTE_IP           NET_IP4(10, 0, 0, 1)
+
+#define LOCAL_PORT          (5000U)
+#define PEER_PORT           (4000U)
+#define ECHO_PORT           (7U)
+
+#define ETH_TYPE_IP4        (0x0800U)
+#define ETH_TYPE_ARP        (0x0806U)
+#define IP_PROTO_ICMP       (1U)
+#define IP_PROTO_UDP        (17U)
+
+// Offsets of an IPv4 frame without options
+#define IP_OFS              (ETH_HDR_LEN)
+#define L4_OFS              (ETH_HDR_LEN + 20U)
+
+/************************************
+ * PRIVATE TYPEDEFS
+ ************************************/
+struct udp_rx {
+    uint32_t count;
+    uint32_t src_ip;
+    uint16_t src_port;
+    uint32_t len;
+    uint8_t data[64];
+};
+
+/************************************
+ * STATIC VARIABLES
+ ************************************/
+static const uint8_t local_mac[ETH_ADDR_LEN] = { 0x02, 0x00, 0x00, 0x17, 0x68, 0x01 };
+static const uint8_t peer_mac[ETH_ADDR_LEN] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 };
+static const uint8_t other_mac[ETH_ADDR_LEN] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x02 };
+static const uint8_t bcast_mac[ETH_ADDR_LEN] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+
+static struct udp_rx udp_rx;
+static uint8_t frame[ETH_TAP_FRAME_MAX];
+
+/************************************
+ * STATIC FUNCTIONS
+ ************************************/
+static uint16_t get16(const uint8_t *p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+        ((uint32_t)p[2] << 8) | p[3];
+}
+
+static void put16(uint8_t *p, uint32_t val)
+{
+    p[0] = (uint8_t)(val >> 8);
+    p[1] = (uint8_t)val;
+}
+
+static void put32(uint8_t *p, uint32_t val)
+{
+    p[0] = (uint8_t)(val >> 24);
+    p[1] = (uint8_t)(val >> 16);
+    p[2] = (uint8_t)(val >> 8);
+    p[3] = (uint8_t)val;
+}
+
+static void eth_header(uint8_t *buf, const uint8_t *dst, const uint8_t *src,
+    uint16_t type)
+{
+    memcpy(&buf[0], dst, ETH_ADDR_LEN);
+    memcpy(&buf[6], src, ETH_ADDR_LEN);
+    put16(&buf[12], type);
+}
+
+static void inject_arp(uint16_t oper, const uint8_t *sha, uint32_t spa,
+    const uint8_t *tha, uint32_t tpa)
+{
+    uint8_t buf[ETH_HDR_LEN + 28U];
+
+    eth_header(buf, (oper == 1U) ? bcast_mac : tha, sha, ETH_TYPE_ARP);
+    put16(&buf[14], 1U);
+    put16(&buf[16], ETH_TYPE_IP4);
+    buf[18] = ETH_ADDR_LEN;
+    buf[19] = 4U;
+    put16(&buf[20], oper);
+    memcpy(&buf[22], sha, ETH_ADDR_LEN);
+    put32(&buf[28], spa);
+    memcpy(&buf[32], tha, ETH_ADDR_LEN);
+    put32(&buf[38], tpa);
+
+    CHECK(!eth_tap_inject(buf, sizeof(buf)));
+    net_host_poll();
+}
+
+/*
+ * IPv4 frame from the peer with the checksums filled in, the last byte
+ * flipped afterwards when damaged
+ */
+static void inject_ip(uint32_t dst, uint8_t proto, const uint8_t *l4,
+    uint32_t len, bool damaged)
+{
+    uint8_t buf[ETH_TAP_FRAME_MAX];
+
+    eth_header(buf, local_mac, peer_mac, ETH_TYPE_IP4);
+    buf[IP_OFS + 0U] = 0x45U;
+    buf[IP_OFS + 1U] = 0U;
+    put16(&buf[IP_OFS + 2U], 20U + len);
+    put16(&buf[IP_OFS + 4U], 0x1234U);
+    put16(&buf[IP_OFS + 6U], 0x4000U);
+    buf[IP_OFS + 8U] = 64U;
+    buf[IP_OFS + 9U] = proto;
+    put16(&buf[IP_OFS + 10U], 0U);
+    put32(&buf[IP_OFS + 12U], PEER_IP);
+    put32(&buf[IP_OFS + 16U], dst);
+    memcpy(&buf[L4_OFS], l4, len);
+    IP_CSUM_FrameInsert(buf, L4_OFS + len, IP_CSUM_Add(0, buf, L4_OFS + len));
+    if (damaged) {
+        buf[L4_OFS + len - 1U] ^= 0x5AU;
+    }
+
+    CHECK(!eth_tap_inject(buf, L4_OFS + len));
+}
+
+static void inject_udp(uint32_t dst, uint16_t dst_port, const char *text)
+{
+    uint8_t udp[8U + 64U];
+    uint32_t len = (uint32_t)strlen(text);
+
+    put16(&udp[0], PEER_PORT);
+    put16(&udp[2], dst_port);
+    put16(&udp[4], 8U + len);
+    put16(&udp[6], 0U);
+    memcpy(&udp[8], text, len);
+    inject_ip(dst, IP_PROTO_UDP, udp, 8U + len, false);
+    net_host_poll();
+}
+
+static bool frame_is_ip(uint32_t len, const uint8_t *dst_mac, uint32_t dst,
+    uint8_t proto)
+{
+    return (len >= L4_OFS) && !memcmp(&frame[0], dst_mac, ETH_ADDR_LEN) &&
+        !memcmp(&frame[6], local_mac, ETH_ADDR_LEN) &&
+        (get16(&frame[12]) == ETH_TYPE_IP4) && (frame[IP_OFS + 9U] == proto) &&
+        (get32(&frame[IP_OFS + 12U]) == LOCAL_IP) &&
+        (get32(&frame[IP_OFS + 16U]) == dst) &&
+        IP_CSUM_FrameCheck(frame, len, IP_CSUM_Add(0, frame, len));
+}
+
+static bool frame_is_arp_request(uint32_t len, uint32_t tpa)
+{
+    return (len >= (ETH_HDR_LEN + 28U)) &&
+        !memcmp(&frame[0], bcast_mac, ETH_ADDR_LEN) &&
+        (get16(&frame[12]) == ETH_TYPE_ARP) && (get16(&frame[20]) == 1U) &&
+        !memcmp(&frame[22], local_mac, ETH_ADDR_LEN) &&
+        (get32(&frame[28]) == LOCAL_IP) && (get32(&frame[38]) == tpa);
+}
+
+static void udp_handler(uint32_t src_ip, uint16_t src_port,
+    const uint8_t *data, uint32_t len)
+{
+    udp_rx.count++;
+    udp_rx.src_ip = src_ip;
+    udp_rx.src_port = src_port;
+    udp_rx.len = len;
+    memcpy(udp_rx.data, data, (len < sizeof(udp_rx.data)) ? len : sizeof(udp_rx.data));
+}
+
+static void udp_echo(uint32_t src_ip, uint16_t src_port, const uint8_t *data,
+    uint32_t len)
+{
+    net_udp_send(src_ip, src_port, ECHO_PORT, data, len);
+}
+
+static void test_arp_reply(void)
+{
+    uint32_t len;
+
+    // Not for us, no reply and nothing learned
+    inject_arp(1U, other_mac, OTHER_IP, bcast_mac, NET_IP4(192, 168, 1, 99));
+    CHECK(eth_tap_sent(frame) == 0U);
+
+    inject_arp(1U, peer_mac, PEER_IP, bcast_mac, LOCAL_IP);
+    len = eth_tap_sent(frame);
+    CHECK(len == (ETH_HDR_LEN + 28U));
+    CHECK(!memcmp(&frame[0], peer_mac, ETH_ADDR_LEN));
+    CHECK(get16(&frame[12]) == ETH_TYPE_ARP);
+    CHECK(get16(&frame[20]) == 2U);
+    CHECK(!memcmp(&frame[22], local_mac, ETH_ADDR_LEN));
+    CHECK(get32(&frame[28]) == LOCAL_IP);
+    CHECK(!memcmp(&frame[32], peer_mac, ETH_ADDR_LEN));
+    CHECK(get32(&frame[38]) == PEER_IP);
+    CHECK(eth_tap_sent(frame) == 0U);
+}
+
+static void test_icmp_echo(void)
+{
+    uint8_t icmp[8U + 56U];
+    uint32_t len, errors;
+
+    icmp[0] = 8U;
+    icmp[1] = 0U;
+    put16(&icmp[2], 0U);
+    put16(&icmp[4], 0xBEEFU);
+    put16(&icmp[6], 1U);
+    for (uint32_t i = 8; i < sizeof(icmp); i++) {
+        icmp[i] = (uint8_t)i;
+    }
+
+    inject_ip(LOCAL_IP, IP_PROTO_ICMP, icmp, sizeof(icmp), false);
+    net_host_poll();
+    len = eth_tap_sent(frame);
+    CHECK(len == (L4_OFS + sizeof(icmp)));
+    CHECK(frame_is_ip(len, peer_mac, PEER_IP, IP_PROTO_ICMP));
+    CHECK(frame[L4_OFS] == 0U);
+    CHECK(!memcmp(&frame[L4_OFS + 4U], &icmp[4], sizeof(icmp) - 4U));
+    CHECK(net_stats.icmp_echo == 1U);
+
+    // Damaged on the way, the MAC drops it and nothing is answered
+    errors = net_stats.rx_errors;
+    inject_ip(LOCAL_IP, IP_PROTO_ICMP, icmp, sizeof(icmp), true);
+    net_host_poll();
+    CHECK(eth_tap_sent(frame) == 0U);
+    CHECK(net_stats.rx_errors == (errors + 1U));
+    CHECK(net_stats.icmp_echo == 1U);
+}
+
+static void test_udp_receive(void)
+{
+    uint32_t dropped, len;
+
+    CHECK(net_udp_bind(LOCAL_PORT, udp_handler) == 0);
+    CHECK(net_udp_bind(LOCAL_PORT, udp_handler) != 0);
+    CHECK(net_udp_bind(0, udp_handler) != 0);
+
+    inject_udp(LOCAL_IP, LOCAL_PORT, "hello");
+    CHECK(udp_rx.count == 1U);
+    CHECK(udp_rx.src_ip == PEER_IP);
+    CHECK(udp_rx.src_port == PEER_PORT);
+    CHECK((udp_rx.len == 5U) && !memcmp(udp_rx.data, "hello", 5));
+
+    // Subnet broadcast reaches the handler too
+    inject_udp(NET_IP4(192, 168, 1, 255), LOCAL_PORT, "all");
+    CHECK(udp_rx.count == 2U);
+
+    // Not bound, not for us
+    dropped = net_stats.rx_dropped;
+    inject_udp(LOCAL_IP, LOCAL_PORT + 1U, "nobody");
+    inject_udp(OTHER_IP, LOCAL_PORT, "other");
+    CHECK(udp_rx.count == 2U);
+    CHECK(net_stats.rx_dropped == (dropped + 2U));
+
+    // Reply from the handler, the peer is in the ARP cache
+    CHECK(net_udp_bind(ECHO_PORT, udp_echo) == 0);
+    inject_udp(LOCAL_IP, ECHO_PORT, "ping");
+    len = eth_tap_sent(frame);
+    CHECK(frame_is_ip(len, peer_mac, PEER_IP, IP_PROTO_UDP));
+    CHECK(get16(&frame[L4_OFS + 0U]) == ECHO_PORT);
+    CHECK(get16(&frame[L4_OFS + 2U]) == PEER_PORT);
+    CHECK((len == (L4_OFS + 8U + 4U)) && !memcmp(&frame[L4_OFS + 8U], "ping", 4));
+}
+
+static void test_udp_resolve(void)
+{
+    uint32_t len;
+
+    // Unknown neighbour, the datagram waits for the address
+    CHECK(net_udp_send(OTHER_IP, PEER_PORT, LOCAL_PORT, "late", 4) == 0);
+    len = eth_tap_sent(frame);
+    CHECK(frame_is_arp_request(len, OTHER_IP));
+    CHECK(eth_tap_sent(frame) == 0U);
+
+    // Asked again after a second
+    net_host_advance(pdMS_TO_TICKS(500));
+    CHECK(eth_tap_sent(frame) == 0U);
+    net_host_advance(pdMS_TO_TICKS(500));
+    CHECK(frame_is_arp_request(eth_tap_sent(frame), OTHER_IP));
+
+    inject_arp(2U, other_mac, OTHER_IP, local_mac, LOCAL_IP);
+    len = eth_tap_sent(frame);
+    CHECK(frame_is_ip(len, other_mac, OTHER_IP, IP_PROTO_UDP));
+    CHECK((len == (L4_OFS + 8U + 4U)) && !memcmp(&frame[L4_OFS + 8U], "late", 4));
+
+    // Off the subnet through the gateway, known from test_arp_reply
+    CHECK(net_udp_send(REMOTE_IP, PEER_PORT, LOCAL_PORT, "far", 3) == 0);
+    CHECK(frame_is_ip(eth_tap_sent(frame), peer_mac, REMOTE_IP, IP_PROTO_UDP));
+
+    // Never answered, given up after the tries
+    CHECK(net_udp_send(NET_IP4(192, 168, 1, 3), PEER_PORT, LOCAL_PORT, "lost", 4) == 0);
+    for (uint32_t i = 0; i < 4U; i++) {
+        net_host_advance(pdMS_TO_TICKS(1000));
+    }
+    while (eth_tap_sent(frame)) {
+    }
+    CHECK(net_host_bufs_used() == 0U);
+}
+
+/*
+ * Answer ARP, ping and UDP echo on port 7 on a TAP interface, e.g.
+ *   ip tuntap add tap0 mode tap user $USER && ip link set tap0 up
+ *   ip addr add 192.168.1.1/24 dev tap0
+ *   net_test tap0 &  ping 192.168.1.50;  nc -u 192.168.1.50 7
+ */
+static int run_tap(const char *name)
+{
+    if (eth_tap_open(name)) {
+        printf("can not open %s\n", name);
+        return 1;
+    }
+
+    net_host_init(local_mac);
+    net_udp_bind(ECHO_PORT, udp_echo);
+    printf("192.168.1.50 on %s, udp echo on port %u\n", name, ECHO_PORT);
+
+    for (;;) {
+        net_host_poll();
+        usleep(1000);
+        net_host_advance(1);
+    }
+}
+
+/************************************
+ * GLOBAL FUNCTIONS
+ ************************************/
+int main(int argc, char *argv[])
+{
+    if (argc > 1) {
+        return run_tap(argv[1]);
+    }
+
+    net_host_init(local_mac);
+    test_arp_reply();
+    test_icmp_echo();
+    test_udp_receive();
+    test_udp_resolve();
+    CHECK(net_host_bufs_used() == 0U);
+
+    return test_result("net");
+}
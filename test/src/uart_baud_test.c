@@ -0,0 +1,205 @@
+/**
+ ********************************************************************************
+ * @file    uart_baud_test.c
+ * @author  prashanth kannan
+ * @date    2/28/24
+ * @brief   UART baud rate divider search against an exhaustive reference
+ ********************************************************************************
+ */
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "stdint.h"
+#include "stdbool.h"
+
+// Drivers
+#include "UART_LPC17xx.h"
+
+// TEST
+#include "test.h"
+
+/************************************
+ * PRIVATE MACROS AND DEFINES
+ ************************************/
+#define CCLK                (100000000U)
+
+// UART0 clock select in PCLKSEL0
+#define PCLKSEL_UART0_POS   (6U)
+
+// Error limit of the driver in parts per million
+#define BAUD_ERROR_MAX      (USART_MAX_BAUDRATE_ERROR * 10000.0)
+
+// Slack for the driver's lookup table, whose fractions are rounded to 1/4096
+#define BAUD_ERROR_SLACK    (250.0)
+
+#define ARRAY_SIZE(a)       (sizeof(a) / sizeof((a)[0]))
+
+/************************************
+ * PRIVATE TYPEDEFS
+ ************************************/
+struct pclk_sel {
+    uint32_t sel;           // PCLKSEL0 field value
+    uint32_t div;           // CCLK divisor it selects
+};
+
+/************************************
+ * STATIC VARIABLES
+ ************************************/
+static LPC_UART_TypeDef uart;
+static volatile uint32_t pclksel0;
+static USART_INFO info;
+
+// UART0 with its registers and the clock select on the host
+static USART_RESOURCES usart = {
+    .reg = &uart,
+    .clk = {
+        .peri_cfg_pos = PCLKSEL_UART0_POS,
+        .peri_cfg = &pclksel0,
+    },
+    .info = &info,
+};
+
+static const struct pclk_sel pclk_sels[] = {
+    { 1U, 1U }, { 2U, 2U }, { 0U, 4U }, { 3U, 8U },
+};
+
+static const uint32_t rates[] = {
+    1200, 2400, 4800, 9600, 14400, 19200, 38400, 57600, 115200, 230400,
+    460800, 921600, 1000000, 1500000, 1562500, 2000000, 3000000, 3125000,
+    6250000,
+};
+
+/************************************
+ * GLOBAL VARIABLES
+ ************************************/
+uint32_t SystemCoreClock = CCLK;
+
+/************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ************************************/
+// Not exported by the driver header
+int32_t USART_SetBaudrate(uint32_t baudrate, USART_RESOURCES *usart);
+
+/************************************
+ * STATIC FUNCTIONS
+ ************************************/
+// Error of a divider setting against the requested rate, in ppm
+static double baud_error(uint32_t pclk, uint32_t baud, uint32_t latch,
+    uint32_t add, uint32_t mul)
+{
+    double req = (double)pclk / baud;
+    double div = 16.0 * latch * (mul ? (1.0 + (double)add / mul) : 1.0);
+
+    return ((div > req) ? (div - req) : (req - div)) / req * 1e6;
+}
+
+/*
+ * Best reachable error over every fractional divider, with the nearest
+ * latch values for each. A fractional divider needs a latch of 3 or more.
+ */
+static double baud_error_best(uint32_t pclk, uint32_t baud)
+{
+    double best = 1e6;
+
+    for (uint32_t mul = 1; mul <= 15U; mul++) {
+        for (uint32_t add = 0; add < mul; add++) {
+            double ideal = (double)pclk * mul / (16.0 * baud * (mul + add));
+            uint32_t latch = (uint32_t)ideal;
+
+            for (uint32_t l = (latch > 1U) ? (latch - 1U) : 1U; l <= (latch + 1U); l++) {
+                double err;
+
+                if ((l > 0xFFFFU) || (add && (l < 3U))) {
+                    continue;
+                }
+                err = baud_error(pclk, baud, l, add, mul);
+                if (err < best) {
+                    best = err;
+                }
+            }
+        }
+    }
+    return best;
+}
+
+/*
+ * Program the rate and read the error of what landed in DLM/DLL/FDR, -1
+ * when the driver rejects the rate
+ */
+static double baud_set(uint32_t pclk, uint32_t baud)
+{
+    uint32_t latch, add, mul;
+
+    uart.DLL = 0;
+    uart.DLM = 0;
+    uart.FDR = 0;
+    if (USART_SetBaudrate(baud, &usart)) {
+        return -1.0;
+    }
+
+    latch = ((uint32_t)uart.DLM << 8) | uart.DLL;
+    add = uart.FDR & 0x0FU;
+    mul = (uart.FDR >> 4) & 0x0FU;
+    CHECK(latch != 0U);
+    CHECK(!add || (mul && (add < mul) && (latch >= 3U)));
+
+    return baud_error(pclk, baud, latch, add, mul);
+}
+
+static void test_table(void)
+{
+    for (uint32_t s = 0; s < ARRAY_SIZE(pclk_sels); s++) {
+        uint32_t pclk = CCLK / pclk_sels[s].div;
+
+        pclksel0 = pclk_sels[s].sel << PCLKSEL_UART0_POS;
+        for (uint32_t r = 0; r < ARRAY_SIZE(rates); r++) {
+            double best = baud_error_best(pclk, rates[r]);
+            double err = baud_set(pclk, rates[r]);
+
+            // Accepted within the limit and close to the best setting,
+            // rejected only when no setting is within the limit
+            if (err >= 0.0) {
+                CHECK(err <= BAUD_ERROR_MAX);
+                if (!CHECK(err <= (best + BAUD_ERROR_SLACK))) {
+                    printf("  pclk /%u %u baud: %.0f ppm, best %.0f ppm\n",
+                        pclk_sels[s].div, rates[r], err, best);
+                }
+            } else if (!CHECK(best > BAUD_ERROR_MAX)) {
+                printf("  pclk /%u %u baud rejected, best %.0f ppm\n",
+                    pclk_sels[s].div, rates[r], best);
+            }
+        }
+    }
+}
+
+/*
+ * Below the fractional limit only an integer latch divider is left: exact
+ * at PCLK / 16 / 2 and PCLK / 16, rejected once the error passes 3%
+ */
+static void test_integer_latch(void)
+{
+    pclksel0 = 1U << PCLKSEL_UART0_POS;
+
+    CHECK(baud_set(CCLK, 3125000U) == 0.0);
+    CHECK((uart.DLL == 2U) && (uart.DLM == 0U) && (uart.FDR == 0U));
+    CHECK(baud_set(CCLK, 6250000U) == 0.0);
+    CHECK((uart.DLL == 1U) && (uart.DLM == 0U) && (uart.FDR == 0U));
+
+    // 4.2% and 3.4% off, the second one used to pass the truncated check
+    CHECK(baud_set(CCLK, 3000000U) < 0.0);
+    CHECK(baud_set(CCLK, 3020000U) < 0.0);
+    // 2.8% off
+    CHECK(baud_set(CCLK, 3040000U) > 0.0);
+}
+
+/************************************
+ * GLOBAL FUNCTIONS
+ ************************************/
+int main(void)
+{
+    test_table();
+    test_integer_latch();
+
+    return test_result("uart_baud");
+}
@@ -0,0 +1,38 @@
+/**
+ ********************************************************************************
+ * @file    FreeRTOS.h
+ * @author  prashanth kannan
+ * @date    2/28/24
+ * @brief   host stand-in for the kernel types the net stack uses
+ ********************************************************************************
+ */
+
+#ifndef FREERTOS_H
+#define FREERTOS_H
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "stdint.h"
+
+/************************************
+ * MACROS AND DEFINES
+ ************************************/
+// One tick per millisecond, as configured for the target
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(ms))
+#define portMAX_DELAY       ((TickType_t)0xFFFFFFFFUL)
+#define pdFALSE             (0)
+#define pdTRUE              (1)
+
+// The host tests run single threaded
+#define taskENTER_CRITICAL()
+#define taskEXIT_CRITICAL()
+
+/************************************
+ * TYPEDEFS
+ ************************************/
+typedef uint32_t TickType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+
+#endif
@@ -0,0 +1,74 @@
+/**
+ ********************************************************************************
+ * @file    cmsis_host.h
+ * @author  prashanth kannan
+ * @date    2/28/24
+ * @brief   host stand-in for the CMSIS compiler intrinsics the drivers use
+ ********************************************************************************
+ */
+
+// Forced in with -include and takes the guard of cmsis_compiler.h, which
+// core_cm3.h would otherwise pick up from its own directory
+#ifndef __CMSIS_COMPILER_H
+#define __CMSIS_COMPILER_H
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "stdint.h"
+
+/************************************
+ * MACROS AND DEFINES
+ ************************************/
+#define __ASM                   __asm
+#define __INLINE                inline
+#define __STATIC_INLINE         static inline
+#define __STATIC_FORCEINLINE    static inline
+#define __NO_RETURN             __attribute__((__noreturn__))
+#define __USED                  __attribute__((used))
+#define __WEAK                  __attribute__((weak))
+#define __PACKED                __attribute__((packed))
+#define __ALIGNED(x)            __attribute__((aligned(x)))
+#define __RESTRICT              __restrict
+#define __COMPILER_BARRIER()    __asm volatile("" ::: "memory")
+
+// Barriers and hints, the host tests run single threaded
+#define __DSB()                 __COMPILER_BARRIER()
+#define __ISB()                 __COMPILER_BARRIER()
+#define __DMB()                 __COMPILER_BARRIER()
+#define __NOP()
+#define __CLREX()
+#define __disable_irq()
+#define __enable_irq()
+
+/************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ************************************/
+// Exclusive accesses always succeed without a second thread
+static inline uint32_t __LDREXW(volatile uint32_t *addr)
+{
+    return *addr;
+}
+
+static inline uint32_t __STREXW(uint32_t value, volatile uint32_t *addr)
+{
+    *addr = value;
+    return 0;
+}
+
+static inline uint8_t __CLZ(uint32_t value)
+{
+    return value ? (uint8_t)__builtin_clz(value) : 32U;
+}
+
+static inline uint32_t __RBIT(uint32_t value)
+{
+    uint32_t result = 0;
+
+    for (uint32_t i = 0; i < 32U; i++) {
+        result = (result << 1) | ((value >> i) & 1U);
+    }
+    return result;
+}
+
+#endif
@@ -0,0 +1,49 @@
+/**
+ ********************************************************************************
+ * @file    semphr.h
+ * @author  prashanth kannan
+ * @date    2/28/24
+ * @brief   host stand-in for the mutex API the net stack uses
+ ********************************************************************************
+ */
+
+#ifndef SEMPHR_H
+#define SEMPHR_H
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "FreeRTOS.h"
+
+/************************************
+ * MACROS AND DEFINES
+ ************************************/
+// Single threaded, a mutex only has to be taken and given in pairs
+#define xSemaphoreCreateMutex()     ((SemaphoreHandle_t)&host_mutex)
+#define xSemaphoreTake(sem, ticks)  host_mutex_take()
+#define xSemaphoreGive(sem)         host_mutex_give()
+
+/************************************
+ * TYPEDEFS
+ ************************************/
+typedef void *SemaphoreHandle_t;
+
+/************************************
+ * EXPORTED VARIABLES
+ ************************************/
+extern int host_mutex;
+
+/************************************
+ * GLOBAL FUNCTIONS
+ ************************************/
+static inline BaseType_t host_mutex_take(void)
+{
+    return (host_mutex++ == 0) ? pdTRUE : pdFALSE;
+}
+
+static inline BaseType_t host_mutex_give(void)
+{
+    return (host_mutex-- == 1) ? pdTRUE : pdFALSE;
+}
+
+#endif
@@ -0,0 +1,24 @@
+/**
+ ********************************************************************************
+ * @file    task.h
+ * @author  prashanth kannan
+ * @date    2/28/24
+ * @brief   host stand-in for the task API the net stack uses
+ ********************************************************************************
+ */
+
+#ifndef TASK_H
+#define TASK_H
+
+/************************************
+ * INCLUDES
+ ************************************/
+#include "FreeRTOS.h"
+
+/************************************
+ * GLOBAL FUNCTION PROTOTYPES
+ ************************************/
+// Ticks are advanced by the test, see net_host.h
+TickType_t xTaskGetTickCount(void);
+
+#endif
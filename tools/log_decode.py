@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+"""
+Decoder for the tokenized serial log (SERIAL_LOG_MODE "tokenized").
+
+Each record on the wire is the varint encoded offset of its format string in
+the .log_fmt section of the ELF, followed by one varint per argument. String
+arguments are sent inline as a varint length and the raw bytes. Records are
+COBS framed and end in a zero byte. A damaged record is reported and skipped,
+decoding picks up again at the next zero.
+
+Usage:
+    log_decode.py build/iar_lpc1768.elf /dev/ttyUSB0
+    log_decode.py build/iar_lpc1768.elf capture.bin
+
+Configure the serial port beforehand, e.g. stty -F /dev/ttyUSB0 115200 raw
+"""
+
+import io
+import re
+import struct
+import sys
+
+SPEC_RE = re.compile(
+    r"%([-+ #0]*)(\d+|\*)?(?:\.(\d+|\*))?(?:hh|h|ll|l|j|z|t)?([diuoxXcspfF%])")
+
+
+def load_formats(elf_path):
+    with open(elf_path, "rb") as f:
+        elf = f.read()
+
+    if elf[:4] != b"\x7fELF" or elf[4] != 1 or elf[5] != 1:
+        sys.exit("%s: not a 32-bit little endian ELF" % elf_path)
+
+    shoff, = struct.unpack_from("<I", elf, 0x20)
+    shentsize, shnum, shstrndx = struct.unpack_from("<HHH", elf, 0x2E)
+
+    def section(idx):
+        return struct.unpack_from("<IIIIIIIIII", elf, shoff + idx * shentsize)
+
+    strtab_off = section(shstrndx)[4]
+    for idx in range(shnum):
+        name, _, _, _, offset, size = section(idx)[:6]
+        end = elf.index(b"\0", strtab_off + name)
+        if elf[strtab_off + name:end] == b".log_fmt":
+            return elf[offset:offset + size]
+
+    sys.exit("%s: no .log_fmt section, is the tokenized log mode on?" % elf_path)
+
+
+def cobs_decode(frame):
+    out = bytearray()
+    idx = 0
+    while idx < len(frame):
+        code = frame[idx]
+        if code == 0 or idx + code > len(frame):
+            raise ValueError
+        out += frame[idx + 1:idx + code]
+        idx += code
+        if code != 0xFF and idx < len(frame):
+            out.append(0)
+    return bytes(out)
+
+
+def read_frame(stream):
+    frame = bytearray()
+    while True:
+        byte = stream.read(1)
+        if not byte:
+            raise EOFError
+        if byte[0] == 0:
+            return bytes(frame)
+        frame += byte
+
+
+def read_varint(stream):
+    val = 0
+    shift = 0
+    while True:
+        byte = stream.read(1)
+        if not byte:
+            raise EOFError
+        val |= (byte[0] & 0x7F) << shift
+        if not byte[0] & 0x80:
+            return val
+        shift += 7
+
+
+def to_signed(val):
+    val &= 0xFFFFFFFF
+    return val - (1 << 32) if val & 0x80000000 else val
+
+
+def decode_record(stream, formats):
+    rec_id = read_varint(stream)
+    if rec_id == 0 or rec_id >= len(formats):
+        return "<bad record id %d>\n" % rec_id
+
+    fmt = formats[rec_id:formats.index(b"\0", rec_id)].decode("ascii", "replace")
+
+    def expand(match):
+        flags, width, prec, spec = match.groups()
+        if spec == "%":
+            return "%"
+
+        # Star width and precision come first, each as its own argument
+        if width == "*":
+            width = str(to_signed(read_varint(stream)))
+        if prec == "*":
+            prec = str(to_signed(read_varint(stream)))
+        pyspec = "%" + flags + (width or "") + ("." + prec if prec else "")
+
+        if spec == "s":
+            val = stream.read(read_varint(stream)).decode("ascii", "replace")
+            return (pyspec + "s") % val
+
+        # Every other argument is a 32-bit word, %f carries its integer part
+        val = read_varint(stream) & 0xFFFFFFFF
+        if spec in "di":
+            return (pyspec + "d") % to_signed(val)
+        if spec == "u":
+            return (pyspec + "d") % val
+        if spec == "p":
+            return ("%#" + pyspec[1:] + "x") % val
+        if spec in "fF":
+            return (pyspec + spec) % float(val)
+        if spec == "c":
+            return (pyspec + "c") % chr(val & 0xFF)
+        return (pyspec + spec) % val
+
+    return SPEC_RE.sub(expand, fmt)
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__)
+
+    formats = load_formats(sys.argv[1])
+    with open(sys.argv[2], "rb", buffering=0) as stream:
+        try:
+            while True:
+                frame = read_frame(stream)
+                if not frame:
+                    continue
+                try:
+                    record = io.BytesIO(cobs_decode(frame))
+                    text = decode_record(record, formats)
+                    if record.read(1):
+                        raise ValueError
+                except (ValueError, EOFError, UnicodeError):
+                    text = "<bad record>\n"
+                sys.stdout.write(text)
+                sys.stdout.flush()
+        except (EOFError, KeyboardInterrupt):
+            pass
+
+
+if __name__ == "__main__":
+    main()